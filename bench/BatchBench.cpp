@@ -0,0 +1,106 @@
+// Rendering thumbnails without a window, as --batch does. The example equations of README.md (or of the file passed
+// first) are repeated up to the number of jobs, written to a file and rendered to a temporary directory at a few image
+// sizes. Reports images per second and the peak resident memory, which should stay about one image per core above
+// the baseline however many jobs there are. Exits with 1 when an equation fails or an image is missing.
+// POSIX only for the memory figure. Build together with every source but main.cpp, Launcher.cpp, Application.cpp
+// and Textbox.cpp, plus tinyexpr and SFML, e.g.
+//     g++ -std=c++20 -O2 -Iinclude bench/BatchBench.cpp src/Batch.cpp src/Graph.cpp src/Equation.cpp src/Expression.cpp
+//         src/Interval.cpp src/Simd.cpp src/Jit.cpp src/Contour.cpp src/Heatmap.cpp src/DataSeries.cpp
+//         src/MappedFile.cpp src/Stream.cpp src/Session.cpp src/ThreadPool.cpp src/Profiler.cpp tinyexpr.c
+//         -lsfml-graphics -lsfml-system
+// and run from the repository root, optionally passing the path of README.md and the number of jobs, 400 by default.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "App/Batch.hpp"
+
+long PeakResidentKilobytes() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    return usage.ru_maxrss;
+}
+
+int main(int argc, char** argv) {
+    const char* readmePath = argc > 1 ? argv[1] : "README.md";
+    const std::size_t count = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 400u;
+
+    // code blocks of the "Example Graphs" section, along with an implicit curve and a scalar field
+    std::vector<std::string> examples = {"x ^ 2 + y ^ 2 = 4", "z = sin(x) * cos(y)"};
+    std::ifstream readme(readmePath);
+
+    bool inSection = false;
+    bool inBlock = false;
+
+    for (std::string line; std::getline(readme, line);) {
+        if (line.rfind("## ", 0u) == 0u) {
+            inSection = line.find("Example Graphs") != std::string::npos;
+        } else if (inSection && line.rfind("```", 0u) == 0u) {
+            inBlock = !inBlock;
+        } else if (inSection && inBlock) {
+            examples.push_back(line);
+        }
+    }
+
+    if (examples.size() == 2u) {
+        std::printf("no example equations found, run from the repository root or pass the path of README.md\n");
+        return 1;
+    }
+
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "BatchBench";
+    const std::string equationsPath = (std::filesystem::temp_directory_path() / "BatchBench.txt").string();
+
+    {
+        std::ofstream equations(equationsPath);
+
+        for (std::size_t i = 0u; i < count; ++i) {
+            equations << examples[i % examples.size()] << '\n';
+        }
+    }
+
+    std::printf("%zu jobs of %zu equations\n", count, examples.size());
+    std::printf("%-10s %10s %12s %12s\n", "size", "images/s", "ms/image", "peak MB");
+
+    bool passed = true;
+
+    for (const char* sizeSpec : {"320x180", "640x360", "1280x720"}) {
+        std::filesystem::remove_all(directory);
+
+        const sf::Vector2u size = Batch::ParseSize(sizeSpec).value();
+        const Batch::View view = Batch::ParseView("-4,4,-2.25,2.25", size).value();
+
+        const auto start = std::chrono::steady_clock::now();
+        auto summary = Batch::Run(equationsPath, directory.string(), view);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (!summary) {
+            std::printf("%s\n", summary.error().c_str());
+            return 1;
+        }
+
+        const std::size_t images = static_cast<std::size_t>(std::distance(std::filesystem::directory_iterator(directory), {}));
+
+        std::printf(
+            "%-10s %10.1f %12.2f %12.1f\n",
+            sizeSpec, summary.value().Rendered / seconds, seconds * 1e3 / count, PeakResidentKilobytes() / 1024.0
+        );
+
+        if (summary.value().Failed || images != count) {
+            std::printf("  %zu failed, %zu of %zu images written\n", summary.value().Failed, images, count);
+            passed = false;
+        }
+    }
+
+    std::filesystem::remove_all(directory);
+    std::filesystem::remove(equationsPath);
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,246 @@
+// Loading and decimating a large data series. A random walk with occasional spikes is written as raw float64 pairs
+// and as CSV, both files are loaded, and the visible part is decimated into pixel columns by min/max and by LTTB for
+// views from the whole series down to a few thousand points, as Graph does whenever the camera comes to rest.
+// Both files have to give the same points, min/max has to match a plain scan of every column point for point, and
+// no view may produce more than two points per column plus the neighbours on either side.
+// Times are the median of Repetitions runs. Exits with 1 when any check fails.
+// Build together with src/DataSeries.cpp, src/MappedFile.cpp and src/ThreadPool.cpp, e.g.
+//     g++ -std=c++20 -O2 -Iinclude bench/DataBench.cpp src/DataSeries.cpp src/MappedFile.cpp src/ThreadPool.cpp
+// and pass the number of points, 10^7 by default.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <limits>
+#include <optional>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "App/DataSeries.hpp"
+
+constexpr unsigned int Repetitions = 5u;
+constexpr unsigned int Columns = 1500u;
+
+template <typename F>
+double MeasureNanoseconds(F&& function) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+double Median(std::vector<double> values) {
+    std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(values.size() / 2u), values.end());
+    return values[values.size() / 2u];
+}
+
+bool Same(const std::vector<sf::Vector2f>& a, const std::vector<sf::Vector2f>& b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](sf::Vector2f p, sf::Vector2f q) {
+        return (p.x == q.x || (std::isnan(p.x) && std::isnan(q.x))) && (p.y == q.y || (std::isnan(p.y) && std::isnan(q.y)));
+    });
+}
+
+// every column scanned point by point, ties go to the earlier point
+std::vector<sf::Vector2f> ReferenceMinMax(const std::vector<double>& xs, const std::vector<double>& ys, double left, double right, double origin) {
+    const auto lower = [&](double value) {
+        return static_cast<std::size_t>(std::lower_bound(xs.begin(), xs.end(), value) - xs.begin());
+    };
+
+    const std::size_t first = lower(left);
+    const std::size_t last = static_cast<std::size_t>(std::upper_bound(xs.begin(), xs.end(), right) - xs.begin());
+
+    const auto point = [&](std::size_t i) {
+        return sf::Vector2f(static_cast<float>(xs[i] - origin), static_cast<float>(-ys[i]));
+    };
+
+    std::vector<sf::Vector2f> points;
+
+    if (first) {
+        points.push_back(point(first - 1u));
+    }
+
+    const double width = (right - left) / Columns;
+
+    for (unsigned int c = 0u; c < Columns; ++c) {
+        const std::size_t begin = c ? lower(left + c * width) : first;
+        const std::size_t end = c + 1u < Columns ? lower(left + (c + 1u) * width) : last;
+
+        std::size_t low = end;
+        std::size_t high = end;
+
+        for (std::size_t i = begin; i < end; ++i) {
+            if (!std::isfinite(ys[i])) {
+                continue;
+            }
+
+            if (low == end || ys[i] < ys[low]) {
+                low = i;
+            }
+
+            if (high == end || ys[i] > ys[high]) {
+                high = i;
+            }
+        }
+
+        if (begin == end) {
+            continue;
+        }
+
+        if (low == end) {
+            points.push_back(point(begin));
+            continue;
+        }
+
+        points.push_back(point(std::min(low, high)));
+
+        if (low != high) {
+            points.push_back(point(std::max(low, high)));
+        }
+    }
+
+    if (last < xs.size()) {
+        points.push_back(point(last));
+    }
+
+    return points;
+}
+
+int main(int argc, char** argv) {
+    const std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000u;
+
+    // one sample per unit of x with some jitter, a random walk with a spike every few thousand points and a few gaps
+    std::vector<double> xs(count);
+    std::vector<double> ys(count);
+
+    std::mt19937_64 random(42u);
+    std::normal_distribution<double> step(0.0, 1.0);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    double walk = 0.0;
+
+    for (std::size_t i = 0u; i < count; ++i) {
+        walk += step(random);
+
+        xs[i] = static_cast<double>(i) + 0.5 * unit(random);
+        ys[i] = unit(random) < 0.0003 ? walk + 200.0 * step(random) : walk;
+
+        if (unit(random) < 0.00001) {
+            ys[i] = std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+
+    const std::filesystem::path directory = std::filesystem::temp_directory_path();
+    const std::string rawPath = (directory / "DataBench.f64").string();
+    const std::string csvPath = (directory / "DataBench.csv").string();
+
+    {
+        std::FILE* raw = std::fopen(rawPath.c_str(), "wb");
+        std::FILE* csv = std::fopen(csvPath.c_str(), "w");
+
+        if (!raw || !csv) {
+            std::printf("couldn't write the series to %s\n", directory.string().c_str());
+            return 1;
+        }
+
+        std::fprintf(csv, "x,y\n");
+
+        for (std::size_t i = 0u; i < count; ++i) {
+            const double pair[2] = {xs[i], ys[i]};
+            std::fwrite(pair, sizeof(double), 2u, raw);
+            std::fprintf(csv, "%.17g,%.17g\n", xs[i], ys[i]);
+        }
+
+        std::fclose(raw);
+        std::fclose(csv);
+    }
+
+    bool failed = false;
+
+    std::printf("%zu points, %.1f MB raw, %.1f MB CSV\n", count, std::filesystem::file_size(rawPath) / 1e6, std::filesystem::file_size(csvPath) / 1e6);
+    std::printf("%-6s %12s\n", "load", "ms");
+
+    std::optional<DataSeries> raw;
+    std::optional<DataSeries> csv;
+
+    for (const auto& [name, path, series] : {std::tuple("raw", &rawPath, &raw), std::tuple("csv", &csvPath, &csv)}) {
+        std::vector<double> times;
+
+        for (unsigned int run = 0u; run < Repetitions; ++run) {
+            times.push_back(MeasureNanoseconds([&, path = path, series = series] {
+                auto result = DataSeries::Load(*path);
+
+                if (!result) {
+                    std::printf("%s\n", result.error().c_str());
+                    std::exit(1);
+                }
+
+                *series = std::move(result).value();
+            }));
+        }
+
+        std::printf("%-6s %12.1f\n", name, Median(times) / 1e6);
+    }
+
+    if (raw->GetSize() != count || csv->GetSize() != count) {
+        std::printf("loaded %zu and %zu points\n", raw->GetSize(), csv->GetSize());
+        failed = true;
+    }
+
+    std::printf("\n%-12s %10s %8s %14s %8s %14s\n", "view", "visible", "min/max", "us/frame", "lttb", "us/frame");
+
+    const double span = xs.back() - xs.front();
+
+    for (double fraction : {1.0, 0.1, 0.01, 0.001, 0.0001}) {
+        const double center = xs.front() + span * 0.37;
+        const double left = fraction == 1.0 ? xs.front() : center - 0.5 * span * fraction;
+        const double right = fraction == 1.0 ? xs.back() : center + 0.5 * span * fraction;
+        const double origin = 0.5 * (left + right); // as Graph picks it
+
+        const std::size_t visible = static_cast<std::size_t>(
+            std::upper_bound(xs.begin(), xs.end(), right) - std::lower_bound(xs.begin(), xs.end(), left)
+        );
+
+        std::printf("%-12g %10zu", fraction, visible);
+
+        for (DataSeries::Decimation method : {DataSeries::Decimation::MinMax, DataSeries::Decimation::Lttb}) {
+            std::vector<sf::Vector2f> points;
+            std::vector<double> times;
+
+            for (unsigned int run = 0u; run < Repetitions; ++run) {
+                times.push_back(MeasureNanoseconds([&] {
+                    points = raw->Decimate(left, right, Columns, method, origin);
+                }));
+            }
+
+            std::printf(" %8zu %14.1f", points.size(), Median(times) / 1e3);
+
+            if (points.size() > 2u * Columns + 2u) {
+                std::printf("\n  too many points\n");
+                failed = true;
+            }
+
+            if (!Same(points, csv->Decimate(left, right, Columns, method, origin))) {
+                std::printf("\n  raw and CSV differ\n");
+                failed = true;
+            }
+
+            if (method == DataSeries::Decimation::MinMax && visible > 2u * Columns && !Same(points, ReferenceMinMax(xs, ys, left, right, origin))) {
+                std::printf("\n  min/max differs from the plain scan\n");
+                failed = true;
+            }
+        }
+
+        std::printf("\n");
+    }
+
+    std::filesystem::remove(rawPath);
+    std::filesystem::remove(csvPath);
+
+    return failed ? 1 : 0;
+}
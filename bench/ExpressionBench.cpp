@@ -0,0 +1,183 @@
+// Per-sample evaluation cost of tinyexpr against the bytecode interpreter in Math::Expression,
+// both one sample at a time and through the batch kernels of every supported instruction set. The joint column
+// compiles x(t) and y(t) into one program as the parametric sampler does, next to the node count of the two
+// separate programs and of the joint one.
+// Build together with src/Expression.cpp, src/Interval.cpp, src/Simd.cpp, src/Jit.cpp and tinyexpr, e.g.
+//     g++ -std=c++20 -O2 -Iinclude bench/ExpressionBench.cpp src/Expression.cpp src/Interval.cpp src/Simd.cpp src/Jit.cpp tinyexpr.c
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "Math/Expression.hpp"
+#include "Math/Simd.hpp"
+
+#include "Vendor/tinyexpr.h"
+
+struct BenchCase {
+    const char* Name;
+    const char* ExpressionX;
+    const char* ExpressionY;
+    double DomainLeft;
+    double DomainRight;
+};
+
+constexpr BenchCase Cases[] = {
+    {
+        "heart",
+        "0.05 * 16 * sin(t) * sin(t) * sin(t)",
+        "0.05 * (13 * cos(t) - 5 * cos(2 * t) - 2 * cos(3 * t) - cos(4 * t))",
+        -3.14159265358979323846, 3.14159265358979323846
+    },
+    {
+        "butterfly",
+        "sin(t) * (exp(cos(t)) - 2 * cos(4 * t) - sin(t / 12) ^ 5)",
+        "cos(t) * (exp(cos(t)) - 2 * cos(4 * t) - sin(t / 12) ^ 5)",
+        0.0, 12.0 * 3.14159265358979323846
+    },
+    {
+        "rose",
+        "cos(4 * t) * cos(t)",
+        "cos(4 * t) * sin(t)",
+        0.0, 2.0 * 3.14159265358979323846
+    },
+    {
+        "lemniscate",
+        "cos(t) / (1 + sin(t) ^ 2)",
+        "sin(t) * cos(t) / (1 + sin(t) ^ 2)",
+        -3.14159265358979323846, 3.14159265358979323846
+    }
+};
+
+constexpr std::size_t SampleCount = 2000000u;
+
+template <typename F>
+double MeasureNanoseconds(F&& function) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+int main() {
+    std::printf("%-12s %14s %14s %9s", "case", "tinyexpr ns", "bytecode ns", "speedup");
+
+    const Math::Simd::Isa supported = Math::Simd::GetSupportedIsa();
+
+    for (uint8_t isa = 0u; isa <= static_cast<uint8_t>(supported); ++isa) {
+        std::printf(" %10s ns", Math::Simd::GetIsaName(static_cast<Math::Simd::Isa>(isa)));
+    }
+
+    std::printf(" %13s %13s\n", "joint ns", "nodes");
+
+    for (const BenchCase& bench : Cases) {
+        const double step = (bench.DomainRight - bench.DomainLeft) / static_cast<double>(SampleCount);
+
+        // tinyexpr
+        double variable = 0.0;
+        te_variable vars[] = {{"t", &variable, TE_VARIABLE, nullptr}};
+
+        int error = 0;
+        te_expr* treeX = te_compile(bench.ExpressionX, vars, 1, &error);
+        te_expr* treeY = te_compile(bench.ExpressionY, vars, 1, &error);
+
+        if (!treeX || !treeY) {
+            std::printf("%-12s tinyexpr failed to compile\n", bench.Name);
+            return 1;
+        }
+
+        double checksumTree = 0.0;
+        const double treeTime = MeasureNanoseconds([&] {
+            for (std::size_t i = 0u; i < SampleCount; ++i) {
+                variable = bench.DomainLeft + step * static_cast<double>(i);
+                checksumTree += te_eval(treeX) + te_eval(treeY);
+            }
+        });
+
+        te_free(treeX);
+        te_free(treeY);
+
+        // bytecode
+        auto resultX = Math::Expression::Compile(bench.ExpressionX, {"t"});
+        auto resultY = Math::Expression::Compile(bench.ExpressionY, {"t"});
+
+        if (!resultX || !resultY) {
+            std::printf("%-12s bytecode failed to compile\n", bench.Name);
+            return 1;
+        }
+
+        const Math::Expression& expressionX = resultX.value();
+        const Math::Expression& expressionY = resultY.value();
+
+        Math::Expression::Context contextX = expressionX.CreateContext();
+        Math::Expression::Context contextY = expressionY.CreateContext();
+
+        double checksumBytecode = 0.0;
+        const double bytecodeTime = MeasureNanoseconds([&] {
+            for (std::size_t i = 0u; i < SampleCount; ++i) {
+                const double t = bench.DomainLeft + step * static_cast<double>(i);
+                checksumBytecode += expressionX.Evaluate(contextX, t) + expressionY.Evaluate(contextY, t);
+            }
+        });
+
+        const double treeSample = treeTime / SampleCount;
+        const double bytecodeSample = bytecodeTime / SampleCount;
+
+        std::printf("%-12s %14.2f %14.2f %8.2fx", bench.Name, treeSample, bytecodeSample, treeSample / bytecodeSample);
+
+        // batch evaluation over the whole parameter array
+        std::vector<double> parameters(SampleCount);
+        std::vector<double> valuesX(SampleCount);
+        std::vector<double> valuesY(SampleCount);
+
+        for (std::size_t i = 0u; i < SampleCount; ++i) {
+            parameters[i] = bench.DomainLeft + step * static_cast<double>(i);
+        }
+
+        for (uint8_t isa = 0u; isa <= static_cast<uint8_t>(supported); ++isa) {
+            Math::Simd::SetIsa(static_cast<Math::Simd::Isa>(isa));
+
+            const double batchTime = MeasureNanoseconds([&] {
+                expressionX.Evaluate(contextX, parameters.data(), valuesX.data(), SampleCount);
+                expressionY.Evaluate(contextY, parameters.data(), valuesY.data(), SampleCount);
+            });
+
+            std::printf(" %13.2f", batchTime / SampleCount);
+        }
+
+        Math::Simd::SetIsa(supported);
+
+        // x(t) and y(t) compiled together, shared subexpressions evaluated once per sample
+        auto resultJoint = Math::Expression::Compile(std::vector<std::string>{bench.ExpressionX, bench.ExpressionY}, {"t"});
+
+        if (!resultJoint) {
+            std::printf("  joint compile failed\n");
+            return 1;
+        }
+
+        const Math::Expression& expressionJoint = resultJoint.value();
+        Math::Expression::Context contextJoint = expressionJoint.CreateContext();
+
+        const double* inputs[] = {parameters.data()};
+        double* const outputs[] = {valuesX.data(), valuesY.data()};
+
+        const double jointTime = MeasureNanoseconds([&] {
+            expressionJoint.Evaluate(contextJoint, inputs, outputs, SampleCount);
+        });
+
+        const Math::Expression::NodeCounts nodes = expressionJoint.GetNodeCounts();
+        const std::size_t separateNodes = expressionX.GetNodeCounts().Shared + expressionY.GetNodeCounts().Shared;
+
+        std::printf(" %13.2f %6zu -> %3zu", jointTime / SampleCount, separateNodes, nodes.Shared);
+
+        if (checksumTree != checksumBytecode) {
+            std::printf("  (checksum differs by %g)", checksumTree - checksumBytecode);
+        }
+
+        std::printf("\n");
+    }
+
+    return 0;
+}
@@ -0,0 +1,256 @@
+// Differential test and throughput of the native backend in Math::Jit over the example equations of README.md.
+// Every example is evaluated by tinyexpr one sample at a time, which is the reference, and by the batch interpreter
+// and the native program of every supported instruction set. The native program has to reproduce the interpreter
+// bit for bit, since both run the same kernels; against tinyexpr the error is measured in ULPs of max(|reference|, 1)
+// so cancellation around zero crossings is not amplified. It has to stay within MaxUlps on top of how far the
+// reference itself moves when the inputs move by one ULP, near the poles of the chaotic example a single rounding
+// of sin turns into thousands of ULPs. NaN has to match NaN.
+// Exits with 1 when any case fails.
+// Build together with src/Expression.cpp, src/Interval.cpp, src/Simd.cpp, src/Jit.cpp and tinyexpr, e.g.
+//     g++ -std=c++20 -O2 -Iinclude bench/JitBench.cpp src/Expression.cpp src/Interval.cpp src/Simd.cpp src/Jit.cpp tinyexpr.c
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Math/Expression.hpp"
+#include "Math/Simd.hpp"
+#include "Math/Jit.hpp"
+
+#include "Vendor/tinyexpr.h"
+
+struct BenchCase {
+    const char* Name;
+    std::vector<std::string> Variables;  // t for parametric curves, x or y for graphs, x and y for implicit and fields
+    std::vector<std::string> Sources;
+    double DomainLeft;
+    double DomainRight;
+};
+
+constexpr double Pi = 3.14159265358979323846;
+
+const BenchCase Cases[] = {
+    {"parabola", {"x"}, {"x * x + 3"}, -10.0, 10.0},
+    {"inverse", {"y"}, {"sin(y) / cos(y)"}, -Pi, Pi},
+    {"heart", {"t"}, {"0.05 * 16 * sin(t) * sin(t) * sin(t)", "0.05 * (13 * cos(t) - 5 * cos(2 * t) - 2 * cos(3 * t) - cos(4 * t))"}, -Pi, Pi},
+    {"rose", {"t"}, {"cos(4 * t) * cos(t)", "cos(4 * t) * sin(t)"}, 0.0, 2.0 * Pi},
+    {"lissajous", {"t"}, {"sin(2 * t)", "cos(3 * t)"}, -5.0, 5.0},
+    {"oscillation", {"x"}, {"x * sin(1 / x)"}, -Pi, Pi},
+    {"chaotic", {"x"}, {"15 * ((sin(x) ^ 3 * 15) - 15) / ((sin(x) ^ 2 * 15) ^ - 1 - 15)"}, -100.0, 100.0},
+    {"lemniscate", {"t"}, {"cos(t) / (1 + sin(t) ^ 2)", "sin(t) * cos(t) / (1 + sin(t) ^ 2)"}, -Pi, Pi},
+    {"butterfly", {"t"}, {"sin(t) * (exp(cos(t)) - 2 * cos(4 * t) - sin(t / 12) ^ 5)", "cos(t) * (exp(cos(t)) - 2 * cos(4 * t) - sin(t / 12) ^ 5)"}, 0.0, 12.0 * Pi},
+    {"circle", {"x", "y"}, {"(x ^ 2 + y ^ 2) - (1)"}, -2.0, 2.0},
+    {"field", {"x", "y"}, {"sin(x) * cos(y)"}, -2.0 * Pi, 2.0 * Pi}
+};
+
+constexpr std::size_t SampleCount = 1000000u;
+
+// the vector kernels trade a few ULPs against libm for throughput, this is what is allowed beyond the condition
+constexpr double MaxUlps = 64.0;
+
+template <typename F>
+double MeasureNanoseconds(F&& function) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+// error of value in units of the last place of max(|reference|, 1), infinite when only one of them is NaN
+double UlpError(double value, double reference) {
+    if (std::isnan(value) || std::isnan(reference)) {
+        return std::isnan(value) == std::isnan(reference) ? 0.0 : INFINITY;
+    }
+
+    if (value == reference) {
+        return 0.0;
+    }
+
+    const double scale = std::max(std::fabs(reference), 1.0);
+
+    if (std::isinf(scale)) {
+        return INFINITY;
+    }
+
+    return std::fabs(value - reference) / (std::nextafter(scale, INFINITY) - scale);
+}
+
+bool BitwiseEqual(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(double)) == 0 || (std::isnan(a) && std::isnan(b));
+}
+
+int main() {
+    const Math::Simd::Isa supported = Math::Simd::GetSupportedIsa();
+
+    if (!Math::Jit::IsAvailable() || supported == Math::Simd::Isa::Scalar) {
+        std::printf("the native backend is not available on this platform\n");
+        return 0;
+    }
+
+    std::printf("%-12s %6s %12s", "case", "isa", "tinyexpr ns");
+    std::printf(" %14s %12s %9s %10s %10s\n", "interpreter ns", "native ns", "speedup", "ulps", "identical");
+
+    bool passed = true;
+
+    for (const BenchCase& bench : Cases) {
+        const std::size_t variableCount = bench.Variables.size();
+        const std::size_t outputCount = bench.Sources.size();
+
+        // a line over the domain, or a square grid over it for two variables
+        std::vector<std::vector<double>> inputs(variableCount, std::vector<double>(SampleCount));
+
+        if (variableCount == 1u) {
+            const double step = (bench.DomainRight - bench.DomainLeft) / static_cast<double>(SampleCount);
+
+            for (std::size_t i = 0u; i < SampleCount; ++i) {
+                inputs[0][i] = bench.DomainLeft + step * static_cast<double>(i);
+            }
+        } else {
+            const std::size_t side = static_cast<std::size_t>(std::sqrt(static_cast<double>(SampleCount)));
+            const double step = (bench.DomainRight - bench.DomainLeft) / static_cast<double>(side);
+
+            for (std::size_t i = 0u; i < SampleCount; ++i) {
+                inputs[0][i] = bench.DomainLeft + step * static_cast<double>(i % side);
+                inputs[1][i] = bench.DomainLeft + step * static_cast<double>(i / side % side);
+            }
+        }
+
+        // tinyexpr
+        std::vector<double> variables(variableCount, 0.0);
+        std::vector<te_variable> bindings;
+
+        for (std::size_t v = 0u; v < variableCount; ++v) {
+            bindings.push_back({bench.Variables[v].c_str(), &variables[v], TE_VARIABLE, nullptr});
+        }
+
+        std::vector<te_expr*> trees;
+
+        for (const std::string& source : bench.Sources) {
+            int error = 0;
+            te_expr* tree = te_compile(source.c_str(), bindings.data(), static_cast<int>(bindings.size()), &error);
+
+            if (!tree) {
+                std::printf("%-12s tinyexpr failed to compile at %d\n", bench.Name, error);
+                return 1;
+            }
+
+            trees.push_back(tree);
+        }
+
+        std::vector<std::vector<double>> reference(outputCount, std::vector<double>(SampleCount));
+        std::vector<std::vector<double>> perturbed(outputCount, std::vector<double>(SampleCount));
+
+        const double treeTime = MeasureNanoseconds([&] {
+            for (std::size_t i = 0u; i < SampleCount; ++i) {
+                for (std::size_t v = 0u; v < variableCount; ++v) {
+                    variables[v] = inputs[v][i];
+                }
+
+                for (std::size_t o = 0u; o < outputCount; ++o) {
+                    reference[o][i] = te_eval(trees[o]);
+                }
+            }
+        });
+
+        // the condition of every sample, the inputs one ULP further up
+        for (std::size_t i = 0u; i < SampleCount; ++i) {
+            for (std::size_t v = 0u; v < variableCount; ++v) {
+                variables[v] = std::nextafter(inputs[v][i], INFINITY);
+            }
+
+            for (std::size_t o = 0u; o < outputCount; ++o) {
+                perturbed[o][i] = te_eval(trees[o]);
+            }
+        }
+
+        for (te_expr* tree : trees) {
+            te_free(tree);
+        }
+
+        std::vector<const double*> inputRows;
+
+        for (const std::vector<double>& input : inputs) {
+            inputRows.push_back(input.data());
+        }
+
+        std::vector<std::vector<double>> interpreted(outputCount, std::vector<double>(SampleCount));
+        std::vector<std::vector<double>> native(outputCount, std::vector<double>(SampleCount));
+
+        std::vector<double*> interpretedRows;
+        std::vector<double*> nativeRows;
+
+        for (std::size_t o = 0u; o < outputCount; ++o) {
+            interpretedRows.push_back(interpreted[o].data());
+            nativeRows.push_back(native[o].data());
+        }
+
+        for (uint8_t isa = static_cast<uint8_t>(Math::Simd::Isa::Sse2); isa <= static_cast<uint8_t>(supported); ++isa) {
+            Math::Simd::SetIsa(static_cast<Math::Simd::Isa>(isa));
+
+            Math::Jit::SetEnabled(false);
+            auto resultInterpreted = Math::Expression::Compile(bench.Sources, bench.Variables);
+
+            Math::Jit::SetEnabled(true);
+            auto resultNative = Math::Expression::Compile(bench.Sources, bench.Variables);
+
+            if (!resultInterpreted || !resultNative || !resultNative.value().IsNative()) {
+                std::printf("%-12s failed to compile\n", bench.Name);
+                return 1;
+            }
+
+            const Math::Expression& expressionInterpreted = resultInterpreted.value();
+            const Math::Expression& expressionNative = resultNative.value();
+
+            Math::Expression::Context contextInterpreted = expressionInterpreted.CreateContext();
+            Math::Expression::Context contextNative = expressionNative.CreateContext();
+
+            const double interpretedTime = MeasureNanoseconds([&] {
+                expressionInterpreted.Evaluate(contextInterpreted, inputRows.data(), interpretedRows.data(), SampleCount);
+            });
+
+            const double nativeTime = MeasureNanoseconds([&] {
+                expressionNative.Evaluate(contextNative, inputRows.data(), nativeRows.data(), SampleCount);
+            });
+
+            double maxUlps = 0.0;
+            bool identical = true;
+
+            for (std::size_t o = 0u; o < outputCount; ++o) {
+                for (std::size_t i = 0u; i < SampleCount; ++i) {
+                    const double sensitivity = UlpError(perturbed[o][i], reference[o][i]);
+                    maxUlps = std::max(maxUlps, UlpError(native[o][i], reference[o][i]) - sensitivity);
+                    identical = identical && BitwiseEqual(native[o][i], interpreted[o][i]);
+                }
+            }
+
+            const bool ok = identical && maxUlps <= MaxUlps;
+            passed = passed && ok;
+
+            std::printf(
+                "%-12s %6s %12.2f %14.2f %12.2f %8.2fx %10.1f %10s%s\n",
+                bench.Name,
+                Math::Simd::GetIsaName(static_cast<Math::Simd::Isa>(isa)),
+                treeTime / SampleCount,
+                interpretedTime / SampleCount,
+                nativeTime / SampleCount,
+                interpretedTime / nativeTime,
+                maxUlps,
+                identical ? "yes" : "no",
+                ok ? "" : "  FAILED"
+            );
+        }
+
+        Math::Simd::SetIsa(supported);
+    }
+
+    Math::Jit::SetEnabled(false);
+
+    std::printf("%s, tolerance %.0f ulps\n", passed ? "passed" : "failed", MaxUlps);
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,179 @@
+// Latency of the input pipeline, measured in three separate steps: Equation::Parse, compiling the resulting
+// expressions into bytecode, and evaluating a single sample. Heap allocations are counted through a replaced
+// global operator new. The corpus mixes typical input with pathological input such as deep nesting and long padding.
+// The last two columns are the expression nodes as written and after merging shared subexpressions.
+// Build together with src/Equation.cpp, src/Expression.cpp, src/Interval.cpp, src/Simd.cpp, src/Jit.cpp and tinyexpr, e.g.
+//     g++ -std=c++20 -O2 -Iinclude bench/ParseBench.cpp src/Equation.cpp src/Expression.cpp src/Interval.cpp src/Simd.cpp src/Jit.cpp tinyexpr.c
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "App/Equation.hpp"
+
+#include "Math/Expression.hpp"
+
+static std::size_t Allocations = 0u;
+
+void* operator new(std::size_t size) {
+    ++Allocations;
+
+    if (void* memory = std::malloc(size ? size : 1u)) {
+        return memory;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+struct BenchCase {
+    std::string Name;
+    std::string Source;
+};
+
+std::vector<BenchCase> MakeCorpus() {
+    std::vector<BenchCase> corpus = {
+        {"variable", "x"},
+        {"explicit", "x * x + 3"},
+        {"explicit x", "sin(y) / cos(y)"},
+        {"domain", "x * x { -2 * pi <= x <= 2 * pi }"},
+        {"heart", "(0.05 * 16 * sin(t) * sin(t) * sin(t), 0.05 * (13 * cos(t) - 5 * cos(2 * t) - 2 * cos(3 * t) - cos(4 * t))) { -pi <= t <= pi }"},
+        {"chaotic", "15 * ((sin(x) ^ 3 * 15) - 15) / ((sin(x) ^ 2 * 15) ^ - 1 - 15) { -100 <= x <= 100 }"},
+        {"implicit", "x ^ 2 + y ^ 2 = 1"},
+        {"implicit sin", "sin(x * y) = 0.5"},
+        {"field", "z = sin(x) * cos(y)"},
+        {"butterfly", "(sin(t) * (exp(cos(t)) - 2 * cos(4 * t) - sin(t / 12) ^ 5), cos(t) * (exp(cos(t)) - 2 * cos(4 * t) - sin(t / 12) ^ 5)) { 0 <= t <= 12 * pi }"}
+    };
+
+    std::string nested = "x";
+    std::string wrapped = "sin(t), cos(t)";
+    std::string sum = "x";
+
+    for (unsigned int i = 0u; i < 200u; ++i) {
+        nested = "sin(" + nested + ")";
+        wrapped = "(" + wrapped + ")";
+    }
+
+    for (unsigned int i = 0u; i < 1000u; ++i) {
+        sum += " + x";
+    }
+
+    corpus.push_back({"nested 200", nested});
+    corpus.push_back({"wrapped 200", wrapped});
+    corpus.push_back({"sum 1000", sum});
+    corpus.push_back({"padded 4096", std::string(4096u, ' ') + "(sin(t), cos(t))" + std::string(4096u, ' ')});
+    corpus.push_back({"symbols y", "y" + std::string(1000u, '+') + "y"});
+
+    return corpus;
+}
+
+struct Measurement {
+    double Nanoseconds;
+    double Allocations;
+};
+
+// repeats until at least 20 ms have passed, reports per call averages
+template <typename F>
+Measurement Measure(F&& function) {
+    using Clock = std::chrono::steady_clock;
+
+    std::size_t iterations = 0u;
+    const std::size_t allocations = Allocations;
+
+    const auto start = Clock::now();
+    auto end = start;
+
+    do {
+        function();
+        ++iterations;
+
+        if (iterations % 16u == 0u) {
+            end = Clock::now();
+        }
+    } while (iterations < 16u || end - start < std::chrono::milliseconds(20));
+
+    end = Clock::now();
+
+    return {
+        std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(iterations),
+        static_cast<double>(Allocations - allocations) / static_cast<double>(iterations)
+    };
+}
+
+int main() {
+    std::printf("%-12s %6s %12s %8s %12s %8s %10s %8s %6s %6s\n", "case", "length", "parse ns", "allocs", "compile ns", "allocs", "sample ns", "allocs", "tree", "shared");
+
+    for (const BenchCase& bench : MakeCorpus()) {
+        auto equation = Equation::Parse(bench.Source);
+
+        const Measurement parse = Measure([&] {
+            equation = Equation::Parse(bench.Source);
+        });
+
+        if (!equation) {
+            std::printf("%-12s %6zu %12.1f %8.1f  (%s)\n", bench.Name.c_str(), bench.Source.size(), parse.Nanoseconds, parse.Allocations, equation.error().c_str());
+            continue;
+        }
+
+        // the same compilation Graph::Generate performs
+        const EquationType type = equation.value().Type;
+        const std::vector<std::string> variables = type == EquationType::Implicit || type == EquationType::ScalarField
+            ? std::vector<std::string>{"x", "y"}
+            : std::vector<std::string>{type == EquationType::Parametric ? "t" : "x"};
+
+        std::vector<std::string> sources;
+
+        for (const std::string* source : {&equation.value().Expression_1, &equation.value().Expression_2}) {
+            if (!source->empty()) {
+                sources.push_back(*source);
+            }
+        }
+
+        // only the compilation is timed, the expression evaluated below comes from a call of its own
+        auto result = Math::Expression::Compile(sources, variables);
+
+        const Measurement compile = Measure([&] {
+            static_cast<void>(Math::Expression::Compile(sources, variables));
+        });
+
+        if (!result) {
+            std::printf("%-12s %6zu %12.1f %8.1f %12.1f %8.1f  (%s)\n", bench.Name.c_str(), bench.Source.size(), parse.Nanoseconds, parse.Allocations, compile.Nanoseconds, compile.Allocations, result.error().c_str());
+            continue;
+        }
+
+        const Math::Expression expression = std::move(result).value();
+
+        Math::Expression::Context context = expression.CreateContext();
+
+        double inputs[] = {0.25, 0.5};
+        double outputs[2];
+        volatile double sink = 0.0;
+
+        const Measurement sample = Measure([&] {
+            expression.Evaluate(context, inputs, outputs);
+            sink = sink + outputs[0];
+
+            inputs[0] += 1e-6;
+        });
+
+        const Math::Expression::NodeCounts nodes = expression.GetNodeCounts();
+
+        std::printf(
+            "%-12s %6zu %12.1f %8.1f %12.1f %8.1f %10.1f %8.1f %6zu %6zu\n",
+            bench.Name.c_str(), bench.Source.size(), parse.Nanoseconds, parse.Allocations,
+            compile.Nanoseconds, compile.Allocations, sample.Nanoseconds, sample.Allocations, nodes.Tree, nodes.Shared
+        );
+    }
+
+    return 0;
+}
@@ -0,0 +1,239 @@
+// Headless frame benchmark over the example equations of README.md.
+// Every example is parsed, sampled and turned into geometry on its own, along with the memory of its LOD levels,
+// then all of them are loaded into Application and driven through scripted idle, pan and zoom phases against
+// an offscreen RenderTexture.
+// Without a GL context only Update is timed. Results are printed as JSON.
+// Build together with every source but main.cpp and Launcher.cpp, plus tinyexpr and SFML, e.g.
+//     g++ -std=c++20 -O2 -Iinclude bench/RenderBench.cpp src/Application.cpp src/Batch.cpp src/Graph.cpp src/Equation.cpp
+//         src/Expression.cpp src/Interval.cpp src/Simd.cpp src/Jit.cpp src/Contour.cpp src/Heatmap.cpp src/ThreadPool.cpp src/Textbox.cpp
+//         src/Session.cpp src/MappedFile.cpp src/DataSeries.cpp src/Stream.cpp src/Profiler.cpp tinyexpr.c
+//         -lsfml-graphics -lsfml-window -lsfml-system
+// and run from the repository root, optionally passing the path of README.md.
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SFML/Graphics.hpp"
+
+#include "App/Application.hpp"
+#include "App/Equation.hpp"
+#include "App/Graph.hpp"
+
+struct Example {
+    std::string Name;
+    std::string Source;
+};
+
+struct Phase {
+    const char* Name;
+    unsigned int Frames;
+    std::function<void(Application& application, unsigned int frame)> Script;
+};
+
+constexpr sf::Vector2u TargetSize = {1500u, 850u};
+constexpr float FrameTime = 1.f / 60.f;
+
+// code blocks of the "Example Graphs" section, named after the heading above them
+std::vector<Example> LoadExamples(const char* path) {
+    std::ifstream file(path);
+    std::vector<Example> examples;
+
+    std::string line;
+    std::string heading;
+    bool inSection = false;
+    bool inBlock = false;
+
+    while (std::getline(file, line)) {
+        if (line.rfind("## ", 0u) == 0u) {
+            inSection = line.find("Example Graphs") != std::string::npos;
+        } else if (!inSection) {
+            continue;
+        } else if (line.rfind("```", 0u) == 0u) {
+            inBlock = !inBlock;
+        } else if (inBlock) {
+            examples.push_back({heading, line});
+        } else if (line.rfind("### ", 0u) == 0u) {
+            // skip the emoji in front of the name
+            const std::size_t start = std::find_if(line.begin() + 4, line.end(), [](char c) { return std::isalpha(static_cast<unsigned char>(c)); }) - line.begin();
+            heading = line.substr(std::min(start, line.size()));
+        }
+    }
+
+    return examples;
+}
+
+template <typename F>
+double MeasureMilliseconds(F&& function) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+double Percentile(std::vector<double> values, double fraction) {
+    if (values.empty()) {
+        return 0.0;
+    }
+
+    const std::size_t index = std::min(values.size() - 1u, static_cast<std::size_t>(fraction * static_cast<double>(values.size())));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+
+    return values[index];
+}
+
+std::string Escape(const std::string& text) {
+    std::string result;
+
+    for (char c : text) {
+        if (c == '\"' || c == '\\') {
+            result += '\\';
+        }
+
+        result += c;
+    }
+
+    return result;
+}
+
+int main(int argc, char** argv) {
+    const std::vector<Example> examples = LoadExamples(argc > 1 ? argv[1] : "README.md");
+
+    if (examples.empty()) {
+        std::fprintf(stderr, "no example equations found, run from the repository root or pass the path of README.md\n");
+        return 1;
+    }
+
+    sf::RenderTexture texture;
+    const bool rendering = texture.resize(TargetSize);
+
+    std::printf("{\n  \"renderer\": \"%s\",\n  \"equations\": [\n", rendering ? "RenderTexture" : "none");
+
+    // --- Per equation ---
+    for (std::size_t i = 0u; i < examples.size(); ++i) {
+        const Example& example = examples[i];
+
+        auto equation = Equation::Parse(example.Source);
+        const double parseTime = MeasureMilliseconds([&] {
+            equation = Equation::Parse(example.Source);
+        });
+
+        if (!equation) {
+            std::fprintf(stderr, "%s: %s\n", example.Name.c_str(), equation.error().c_str());
+            return 1;
+        }
+
+        Graph graph(false);
+        const double sampleTime = MeasureMilliseconds([&] {
+            graph.Generate(equation.value());
+        });
+
+        // the first draw builds and uploads the geometry
+        std::string geometryTime = "null";
+
+        if (rendering) {
+            geometryTime = std::to_string(MeasureMilliseconds([&] {
+                graph.Render(texture, sf::Color::White, {0.f, 0.f}, 200.f);
+                texture.display();
+            }));
+        }
+
+        // what drawing at each level costs, the tags that pick the levels take a byte per point on top
+        std::string lod;
+
+        for (std::size_t k = 0u; k < graph.GetLodMemory().size(); ++k) {
+            const Graph::LevelMemory& level = graph.GetLodMemory()[k];
+
+            char entry[96];
+            std::snprintf(entry, sizeof(entry), "%s{\"level\": %zu, \"points\": %zu, \"bytes\": %zu}", k ? ", " : "", k, level.Points, level.Bytes);
+            lod += entry;
+        }
+
+        std::printf(
+            "    {\"name\": \"%s\", \"points\": %zu, \"parse_ms\": %.4f, \"sample_ms\": %.4f, \"geometry_ms\": %s, \"lod_tag_bytes\": %zu, \"lod\": [%s]}%s\n",
+            Escape(example.Name).c_str(), graph.GetPoints().size(), parseTime, sampleTime, geometryTime.c_str(),
+            graph.GetLod().Levels.size(), lod.c_str(), i + 1u < examples.size() ? "," : ""
+        );
+    }
+
+    std::printf("  ],\n  \"phases\": [\n");
+
+    // --- Scripted session ---
+    Application application;
+
+    for (const Example& example : examples) {
+        application.AddEquation(example.Source);
+    }
+
+    while (application.IsGenerating()) {
+        application.Update(FrameTime);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    const sf::Vector2i center = sf::Vector2i(TargetSize / 2u);
+
+    const Phase phases[] = {
+        {"idle", 240u, [](Application&, unsigned int) {}},
+        {"pan", 240u, [center](Application& app, unsigned int frame) {
+            if (frame == 0u) {
+                app.State.MousePosition = center;
+                app.HandleMouseButtonPress(sf::Mouse::Button::Left);
+            }
+
+            // a circle of 300 px around the center, released on the last frame
+            const float angle = static_cast<float>(frame) * 0.05f;
+            app.State.MousePosition = center + sf::Vector2i(static_cast<int>(300.f * std::cos(angle)), static_cast<int>(300.f * std::sin(angle)));
+
+            if (frame == 239u) {
+                app.HandleMouseButtonRelease(sf::Mouse::Button::Left);
+            }
+        }},
+        {"zoom in", 240u, [](Application& app, unsigned int frame) {
+            if (frame % 10u == 0u) {
+                app.HandleMouseWheelScroll(1.f);
+            }
+        }},
+        {"zoom out", 240u, [](Application& app, unsigned int frame) {
+            if (frame % 10u == 0u) {
+                app.HandleMouseWheelScroll(-1.f);
+            }
+        }},
+        {"settle", 240u, [](Application&, unsigned int) {}}
+    };
+
+    for (std::size_t p = 0u; p < std::size(phases); ++p) {
+        const Phase& phase = phases[p];
+        std::vector<double> frameTimes;
+
+        for (unsigned int frame = 0u; frame < phase.Frames; ++frame) {
+            phase.Script(application, frame);
+
+            frameTimes.push_back(MeasureMilliseconds([&] {
+                application.Update(FrameTime);
+
+                if (rendering) {
+                    application.Render(texture);
+                    texture.display();
+                }
+            }));
+        }
+
+        std::printf(
+            "    {\"name\": \"%s\", \"frames\": %u, \"p50_ms\": %.4f, \"p90_ms\": %.4f, \"p99_ms\": %.4f, \"max_ms\": %.4f}%s\n",
+            phase.Name, phase.Frames, Percentile(frameTimes, 0.5), Percentile(frameTimes, 0.9), Percentile(frameTimes, 0.99),
+            *std::max_element(frameTimes.begin(), frameTimes.end()), p + 1u < std::size(phases) ? "," : ""
+        );
+    }
+
+    std::printf("  ]\n}\n");
+
+    return 0;
+}
@@ -0,0 +1,125 @@
+// Cost of turning an equation into points: adaptive sampling over the whole domain as Graph::Generate and the
+// callback setters do it, and resampling explicit graphs for a scripted pan and zoom as Graph::UpdateViewport does
+// every time the camera moves. Expressions come from the examples of README.md, callbacks are plain lambdas.
+// Times are the median of Repetitions runs, per run and per produced point.
+// Build together with src/Graph.cpp, src/Equation.cpp, src/Expression.cpp, src/Interval.cpp, src/Simd.cpp,
+// src/Jit.cpp, src/Contour.cpp, src/Heatmap.cpp, src/DataSeries.cpp, src/MappedFile.cpp, src/Stream.cpp, src/ThreadPool.cpp,
+// tinyexpr and SFML, e.g.
+//     g++ -std=c++20 -O2 -Iinclude bench/SamplingBench.cpp src/Graph.cpp src/Equation.cpp src/Expression.cpp
+//         src/Interval.cpp src/Simd.cpp src/Jit.cpp src/Contour.cpp src/Heatmap.cpp src/DataSeries.cpp
+//         src/MappedFile.cpp src/Stream.cpp src/ThreadPool.cpp tinyexpr.c
+//         -lsfml-graphics -lsfml-window -lsfml-system
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+#include "App/Equation.hpp"
+#include "App/Graph.hpp"
+
+struct BenchCase {
+    const char* Name;
+    std::function<bool(Graph& graph)> Generate;
+    bool Explicit; // resampled per viewport
+};
+
+constexpr unsigned int Repetitions = 31u;
+constexpr unsigned int PanFrames = 120u;
+
+bool FromSource(Graph& graph, const char* source) {
+    auto equation = Equation::Parse(source);
+    return equation && !graph.Generate(equation.value());
+}
+
+const BenchCase Cases[] = {
+    {"parabola", [](Graph& graph) { return FromSource(graph, "x * x { -2 * pi <= x <= 2 * pi }"); }, true},
+    {"oscillation", [](Graph& graph) { return FromSource(graph, "x * sin(1 / x) { -pi <= x <= pi }"); }, true},
+    {"chaotic", [](Graph& graph) { return FromSource(graph, "15 * ((sin(x) ^ 3 * 15) - 15) / ((sin(x) ^ 2 * 15) ^ - 1 - 15) { -100 <= x <= 100 }"); }, true},
+    {"inverse", [](Graph& graph) { return FromSource(graph, "sin(y) / cos(y)"); }, true},
+    {"heart", [](Graph& graph) { return FromSource(graph, "(0.05 * 16 * sin(t) * sin(t) * sin(t), 0.05 * (13 * cos(t) - 5 * cos(2 * t) - 2 * cos(3 * t) - cos(4 * t))) { -pi <= t <= pi }"); }, false},
+    {"butterfly", [](Graph& graph) { return FromSource(graph, "(sin(t) * (exp(cos(t)) - 2 * cos(4 * t) - sin(t / 12) ^ 5), cos(t) * (exp(cos(t)) - 2 * cos(4 * t) - sin(t / 12) ^ 5)) { 0 <= t <= 12 * pi }"); }, false},
+    {"callback y", [](Graph& graph) {
+        graph.SetExplicitCallback([](double x) { return x * std::sin(1.0 / x); }, -3.0, 3.0);
+        return true;
+    }, true},
+    {"callback t", [](Graph& graph) {
+        graph.SetParametricCallback([](double t) { return sf::Vector2f(static_cast<float>(std::cos(4.0 * t) * std::cos(t)), static_cast<float>(std::cos(4.0 * t) * std::sin(t))); }, 0.0, 6.3);
+        return true;
+    }, false}
+};
+
+template <typename F>
+double MeasureNanoseconds(F&& function) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+double Median(std::vector<double> values) {
+    std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(values.size() / 2u), values.end());
+    return values[values.size() / 2u];
+}
+
+int main() {
+    std::printf("%-12s %8s %14s %12s %14s %12s\n", "case", "points", "generate us", "ns/point", "pan us/frame", "ns/point");
+
+    for (const BenchCase& bench : Cases) {
+        std::vector<double> generateTimes;
+        std::size_t points = 0u;
+
+        for (unsigned int run = 0u; run < Repetitions; ++run) {
+            Graph graph(false);
+            bool generated = false;
+
+            generateTimes.push_back(MeasureNanoseconds([&] {
+                generated = bench.Generate(graph);
+            }));
+
+            if (!generated) {
+                std::printf("%-12s failed to generate\n", bench.Name);
+                return 1;
+            }
+
+            points = graph.GetPoints().size();
+        }
+
+        const double generateTime = Median(generateTimes);
+
+        std::printf("%-12s %8zu %14.1f %12.1f", bench.Name, points, generateTime / 1000.0, generateTime / static_cast<double>(std::max<std::size_t>(points, 1u)));
+
+        if (!bench.Explicit) {
+            std::printf(" %14s %12s\n", "-", "-");
+            continue;
+        }
+
+        // pan across while slowly zooming in, so every frame samples part of the screen anew
+        std::vector<double> panTimes;
+        std::size_t panPoints = 0u;
+
+        for (unsigned int run = 0u; run < Repetitions; ++run) {
+            Graph graph(false);
+            bench.Generate(graph);
+
+            panPoints = 0u;
+
+            panTimes.push_back(MeasureNanoseconds([&] {
+                for (unsigned int frame = 0u; frame < PanFrames; ++frame) {
+                    const float zoom = 100.f * std::pow(1.01f, static_cast<float>(frame));
+                    graph.UpdateViewport({{static_cast<float>(frame) * 7.f, 0.f}, {1500u, 850u}, zoom});
+                    panPoints += graph.GetPoints().size();
+                }
+            }));
+        }
+
+        const double panTime = Median(panTimes);
+
+        std::printf(" %14.1f %12.1f\n", panTime / PanFrames / 1000.0, panTime / static_cast<double>(std::max<std::size_t>(panPoints, 1u)));
+    }
+
+    return 0;
+}
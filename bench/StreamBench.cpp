@@ -0,0 +1,222 @@
+// Live samples through a named pipe as the plot reads them. A writer thread formats (t, y) lines and writes them
+// into the pipe as fast as it can while the consumer drains the stream once per 60 Hz frame, as Graph::Update
+// does, first with the reader waiting for room and then with it dropping what doesn't fit. The ring buffer on its
+// own is measured as well, one thread pushing and one popping.
+// Reports the ingest rate, drops, stalls and the time a frame spends draining. Exits with 1 when a line goes missing
+// or fails to parse, when a blocking stream drops a sample, or when the ring buffer reorders or loses items.
+// POSIX only. Build together with src/Stream.cpp, src/DataSeries.cpp, src/MappedFile.cpp and src/ThreadPool.cpp, e.g.
+//     g++ -std=c++20 -O2 -Iinclude bench/StreamBench.cpp src/Stream.cpp src/DataSeries.cpp src/MappedFile.cpp src/ThreadPool.cpp
+// and pass the number of samples, 4 * 10^6 by default.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "App/Stream.hpp"
+
+#include "System/RingBuffer.hpp"
+
+constexpr auto FrameTime = std::chrono::microseconds(16667);
+
+double Percentile(std::vector<double> values, double fraction) {
+    const std::size_t index = std::min(values.size() - 1u, static_cast<std::size_t>(fraction * values.size()));
+    std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(index), values.end());
+    return values[index];
+}
+
+bool BenchStream(const std::string& path, std::size_t count, Stream::Overflow overflow) {
+    std::filesystem::remove(path);
+
+    if (mkfifo(path.c_str(), 0600) != 0) {
+        std::printf("couldn't create a pipe at %s\n", path.c_str());
+        return false;
+    }
+
+    auto result = Stream::Open(path, 10.0, overflow);
+
+    if (!result) {
+        std::printf("%s\n", result.error().c_str());
+        return false;
+    }
+
+    std::unique_ptr<Stream> stream = std::move(result).value();
+
+    // a sine sampled at 1 MHz of stream time, in chunks about the size of a pipe's buffer
+    std::thread writer([&] {
+        const int descriptor = open(path.c_str(), O_WRONLY);
+
+        std::string chunk;
+
+        for (std::size_t i = 0u; i < count; ++i) {
+            char line[64];
+            const int length = std::snprintf(line, sizeof(line), "%.9f,%.6f\n", i * 1e-6, std::sin(i * 1e-3));
+            chunk.append(line, static_cast<std::size_t>(length));
+
+            if (chunk.size() >= 60000u || i + 1u == count) {
+                for (std::size_t written = 0u; written < chunk.size();) {
+                    const ssize_t n = write(descriptor, chunk.data() + written, chunk.size() - written);
+
+                    if (n <= 0) {
+                        break;
+                    }
+
+                    written += static_cast<std::size_t>(n);
+                }
+
+                chunk.clear();
+            }
+        }
+
+        close(descriptor);
+    });
+
+    std::vector<sf::Vector2f> points;
+    std::vector<double> drainTimes;
+    std::size_t maxQueued = 0u;
+
+    const auto start = std::chrono::steady_clock::now();
+    auto frame = start;
+
+    while (true) {
+        const Stream::Stats before = stream->GetStats();
+        maxQueued = std::max(maxQueued, before.Queued);
+
+        const auto drainStart = std::chrono::steady_clock::now();
+        stream->Drain(points);
+        drainTimes.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - drainStart).count());
+
+        // what Graph does as well, only the window is kept
+        if (points.size() > 4u * Stream::BucketsPerWindow) {
+            const float shift = static_cast<float>(stream->Rebase(points[points.size() / 2u].x));
+            points.erase(points.begin(), points.begin() + static_cast<std::ptrdiff_t>(points.size() / 2u));
+
+            for (sf::Vector2f& point : points) {
+                point.x -= shift;
+            }
+        }
+
+        if (before.Closed && !before.Queued) {
+            break;
+        }
+
+        frame += FrameTime;
+        std::this_thread::sleep_until(frame);
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    writer.join();
+    std::filesystem::remove(path);
+
+    const Stream::Stats stats = stream->GetStats();
+
+    std::printf(
+        "%-6s %10.2f %10llu %10llu %8llu %10zu %10.1f %10.1f\n",
+        overflow == Stream::Overflow::Block ? "block" : "drop",
+        stats.Received / seconds / 1e6,
+        static_cast<unsigned long long>(stats.Received),
+        static_cast<unsigned long long>(stats.Dropped),
+        static_cast<unsigned long long>(stats.Stalls),
+        maxQueued,
+        Percentile(drainTimes, 0.5),
+        Percentile(drainTimes, 0.99)
+    );
+
+    bool passed = true;
+
+    if (stats.Received != count) {
+        std::printf("  received %llu of %zu samples\n", static_cast<unsigned long long>(stats.Received), count);
+        passed = false;
+    }
+
+    if (overflow == Stream::Overflow::Block && stats.Dropped) {
+        std::printf("  a blocking stream dropped samples\n");
+        passed = false;
+    }
+
+    if (stats.Malformed) {
+        std::printf("  %llu malformed lines\n", static_cast<unsigned long long>(stats.Malformed));
+        passed = false;
+    }
+
+    return passed;
+}
+
+bool BenchRing(std::size_t count) {
+    System::RingBuffer<Stream::Sample> ring(Stream::Capacity);
+
+    const auto start = std::chrono::steady_clock::now();
+
+    std::thread producer([&] {
+        std::vector<Stream::Sample> batch(1024u);
+
+        for (std::size_t sent = 0u; sent < count;) {
+            const std::size_t size = std::min(batch.size(), count - sent);
+
+            for (std::size_t i = 0u; i < size; ++i) {
+                batch[i] = {static_cast<double>(sent + i), 0.0};
+            }
+
+            for (std::size_t pushed = 0u; pushed < size;) {
+                pushed += ring.Push(batch.data() + pushed, size - pushed);
+            }
+
+            sent += size;
+        }
+    });
+
+    std::vector<Stream::Sample> batch(4096u);
+    std::size_t received = 0u;
+    bool ordered = true;
+
+    while (received < count) {
+        const std::size_t popped = ring.Pop(batch.data(), batch.size());
+
+        for (std::size_t i = 0u; i < popped; ++i) {
+            ordered &= batch[i].T == static_cast<double>(received + i);
+        }
+
+        received += popped;
+    }
+
+    producer.join();
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("\nring buffer: %.1f M samples/s\n", count / seconds / 1e6);
+
+    if (!ordered) {
+        std::printf("  items were reordered or lost\n");
+    }
+
+    return ordered;
+}
+
+int main(int argc, char** argv) {
+    const std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4'000'000u;
+
+    const std::string path = (std::filesystem::temp_directory_path() / "StreamBench.fifo").string();
+
+    std::printf("%zu samples, drained every %.1f ms\n", count, FrameTime.count() / 1e3);
+    std::printf("%-6s %10s %10s %10s %8s %10s %10s %10s\n", "policy", "M/s", "received", "dropped", "stalls", "max queue", "drain p50", "drain p99");
+
+    bool passed = true;
+
+    for (Stream::Overflow overflow : {Stream::Overflow::Block, Stream::Overflow::Drop}) {
+        passed &= BenchStream(path, count, overflow);
+    }
+
+    passed &= BenchRing(count * 25u);
+
+    return passed ? 0 : 1;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <string>
 #include <vector>
 
 #include "SFML/Graphics.hpp"
@@ -25,21 +26,44 @@ private:
     void updatePanning();
     void updateZoom(float deltaTime);
     void updateViewport(float deltaTime);
+    void updatePreview(float deltaTime);
 
     void renderGizmo(sf::RenderTarget& target);
+    void buildGizmoGrid(sf::Vector2u targetSize);
     void renderColorRect(sf::RenderTarget& target, sf::Color color);
 
+    // a line of counters for every stream in the corner, in the color of its graph, and one with the memory of
+    // every graph's points and levels of detail while that is shown
+    void renderStats(sf::RenderTarget& target);
+
     float m_GizmoScale;
     float m_ZoomMomentum{0.f};
 
     sf::Vector2f m_Position{0.f, 0.f};
+    sf::Vector2u m_ViewportSize{0u, 0u};
+
+    // grid lines centered on the screen for the current scale, drawn translated by the pan offset
+    sf::VertexArray m_GridGeometry{sf::PrimitiveType::Lines};
+    float m_GridScale{0.f};
+    sf::Vector2u m_GridSize{0u, 0u};
 
     std::vector<Graph> m_Graphs;
 
+    // last valid preview stays visible while the pending one is generated in the background
+    Graph m_Preview{false};
+    Graph m_PendingPreview{false};
+    std::string m_PreviewSource;
+    float m_PreviewDebounce{0.f};
+
+    std::string m_SessionPath{"session.graph"};
+
+    DataSeries::Decimation m_Decimation{DataSeries::Decimation::MinMax};
+
     bool m_Grabbed{false};
     bool m_RestoringDefaultView{false};
     bool m_GettingUserInput{false};
     bool m_ShowPreview{false};
+    bool m_ShowMemory{false};
 
     sf::Font m_Font;
     Textbox m_Textbox;
@@ -62,6 +86,21 @@ public:
     void HandleMouseButtonRelease(sf::Mouse::Button button);
     void HandleMouseWheelScroll(float delta);
 
+    // same as typing the equation and pressing Enter, generated in the background
+    void AddEquation(std::string source);
+
+    // loaded in the background like an equation, see DataSeries::Load for the formats
+    void AddDataSeries(std::string path);
+
+    // scrolls along with the samples read from path, see Stream::Open
+    void AddStream(const std::string& path, double window, Stream::Overflow overflow);
+
+    // replaces the graphs and the view with the ones saved at path, which Ctrl+S and Ctrl+O use from then on
+    void OpenSession(std::string path);
+    void SaveSession();
+
+    [[nodiscard]] bool IsGenerating() const;
+
     [[nodiscard]] std::optional<SignalType> ConsumeSignal();
 
     State State;
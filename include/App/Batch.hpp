@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "SFML/Graphics.hpp"
+
+#include "App/Graph.hpp"
+
+#include "System/Error.hpp"
+
+// Renders equations to PNG files without a window: each one is sampled like a graph of the application and drawn
+// on the CPU, so no display or GL context is needed. Jobs are spread over the shared thread pool and every job
+// holds one image, so at most one image per core is in memory however many equations there are.
+class Batch final {
+public:
+    struct View {
+        sf::Vector2u Size{640u, 360u};
+        sf::Vector2f Center{0.f, 0.f}; // world coordinates
+        float Zoom{80.f};              // pixels per world unit
+    };
+
+    struct Summary {
+        std::size_t Rendered;
+        std::size_t Failed;
+    };
+
+    static constexpr unsigned int MaxImageSide = 16384u;
+
+private:
+    // an RGBA image on the CPU, along with the coverage of the curve being drawn
+    struct Canvas {
+        sf::Vector2u Size;
+        std::vector<uint8_t> Pixels;
+        std::vector<float> Coverage;
+    };
+
+    [[nodiscard]] static Graph::Viewport viewport(const View& view);
+
+    static void drawGrid(Canvas& canvas, const View& view);
+
+    // antialiased line of Graph::LineThickness pixels through every run of the points, blended in once
+    static void drawCurve(Canvas& canvas, const View& view, const std::vector<sf::Vector2f>& points, sf::Color color);
+
+    static std::optional<std::string> renderOne(const std::string& source, const View& view, Canvas& canvas, const std::string& path);
+
+public:
+    // "left,right,bottom,top" in world coordinates, fitted into the size so both ranges are visible
+    static System::Error::ResultWrapper<View> ParseView(const std::string& spec, sf::Vector2u size);
+
+    // "<width>x<height>"
+    static System::Error::ResultWrapper<sf::Vector2u> ParseSize(const std::string& spec);
+
+    // one equation per line of the file, blank lines and lines starting with # are skipped; the image of line N is
+    // written to directory/N.png with N padded to five digits, failures are reported on stderr and skipped
+    static System::Error::ResultWrapper<Summary> Run(const std::string& equationsPath, const std::string& directory, const View& view);
+};
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "SFML/Graphics.hpp"
+
+#include "System/Error.hpp"
+#include "System/MappedFile.hpp"
+
+// measured (x, y) samples read from disk, drawn next to the analytic curves. Raw files are used straight from the
+// mapping, CSV is parsed once on the shared thread pool. Rather than every point, each viewport gets a couple of
+// points per pixel column, so the geometry stays the size of the screen however many points there are.
+class DataSeries final {
+public:
+    enum class Decimation : uint8_t {
+        MinMax, // lowest and highest point of every column, keeps every spike
+        Lttb    // largest triangle three buckets, one point per column that best keeps the shape
+    };
+
+    static constexpr std::size_t BlockSize = 128u; // points summarised by one entry of m_Blocks
+
+private:
+    // indices of the lowest and the highest finite y, npos when there is none
+    struct Extremes {
+        std::size_t Min;
+        std::size_t Max;
+    };
+
+    [[nodiscard]] inline double x(std::size_t i) const noexcept {
+        return m_Values[2u * i];
+    }
+
+    [[nodiscard]] inline double y(std::size_t i) const noexcept {
+        return m_Values[2u * i + 1u];
+    }
+
+    // first point with x >= value, and first point with x > value
+    [[nodiscard]] std::size_t lowerBound(double value) const;
+    [[nodiscard]] std::size_t upperBound(double value) const;
+
+    // extremes of [begin, end) point by point
+    [[nodiscard]] Extremes scanPoints(std::size_t begin, std::size_t end) const;
+
+    // the same, whole blocks are taken from m_Blocks
+    [[nodiscard]] Extremes scan(std::size_t begin, std::size_t end) const;
+
+    // ties keep the extreme of `extremes`, so merging from left to right keeps the first of equal points
+    void merge(Extremes& extremes, const Extremes& other) const;
+
+    // fails when x does not increase, or with nothing summarised once `cancelled` is set
+    [[nodiscard]] std::optional<std::string> summarise(const std::string& path, const std::atomic<bool>* cancelled);
+
+    [[nodiscard]] std::vector<sf::Vector2f> minMax(
+        const std::vector<std::size_t>& bounds, std::size_t begin, std::size_t end, double origin, const std::atomic<bool>* cancelled
+    ) const;
+    [[nodiscard]] std::vector<sf::Vector2f> lttb(
+        const std::vector<std::size_t>& bounds, std::size_t begin, std::size_t end, double origin, const std::atomic<bool>* cancelled
+    ) const;
+
+    // x is taken relative to the origin before it is narrowed, so points keep their spacing far from x = 0
+    [[nodiscard]] inline sf::Vector2f point(std::size_t i, double origin) const noexcept {
+        return {static_cast<float>(x(i) - origin), static_cast<float>(-y(i))};
+    }
+
+    // interleaved x and y, either in the mapping of a raw file or parsed from CSV; m_Values points into one of them,
+    // both keep their address when moved
+    System::MappedFile m_File;
+    std::vector<double> m_Parsed;
+    const double* m_Values{nullptr};
+    std::size_t m_Count{0u};
+
+    std::vector<Extremes> m_Blocks;
+
+public:
+    // files ending in .f64 or .bin hold native float64 (x, y) pairs, anything else is read as CSV, where a row of
+    // one number is y at x = row and a row of more numbers uses the first two; rows that don't parse are skipped.
+    // Fails as soon as it sees `cancelled` set
+    static System::Error::ResultWrapper<DataSeries> Load(const std::string& path, const std::atomic<bool>* cancelled = nullptr);
+
+    // reads up to `count` numbers of a row separated by commas, semicolons or blanks into out, stops at the first
+    // field that isn't a number and returns how many were read
+    static unsigned int ParseRow(const char* begin, const char* end, double* out, unsigned int count);
+
+    // points for the x range [left, right] split into `columns` pixel columns, in the flipped space graphs are
+    // stored in, with one more point on either side so the line runs off the screen; all of them when there are
+    // fewer than two per column. x is relative to `origin`, pick one near the range so timestamps and other large
+    // x don't lose their precision as floats. Returns nothing once `cancelled` is set
+    [[nodiscard]] std::vector<sf::Vector2f> Decimate(
+        double left, double right, unsigned int columns, Decimation method, double origin = 0.0,
+        const std::atomic<bool>* cancelled = nullptr
+    ) const;
+
+    [[nodiscard]] inline std::size_t GetSize() const noexcept {
+        return m_Count;
+    }
+};
@@ -6,9 +6,11 @@
 #include "System/Error.hpp"
 
 enum class EquationType : uint8_t {
-    Explicit_X, // x = f(y)
-    Explicit_Y, // y = f(x)
-    Parametric, // y = f(t), x = g(t)
+    Explicit_X,  // x = f(y)
+    Explicit_Y,  // y = f(x)
+    Parametric,  // y = f(t), x = g(t)
+    Implicit,    // f(x, y) = 0
+    ScalarField, // z = f(x, y)
 };
 
 enum class Axis : bool {
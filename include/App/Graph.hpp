@@ -1,22 +1,244 @@
 #pragma once
 
 #include <functional>
+#include <optional>
+#include <variant>
+#include <memory>
+#include <limits>
+#include <map>
 
 #include "SFML/Graphics.hpp"
 
+#include "App/DataSeries.hpp"
 #include "App/Equation.hpp"
+#include "App/Heatmap.hpp"
+#include "App/Stream.hpp"
+
+#include "Math/Contour.hpp"
+#include "Math/Expression.hpp"
+#include "Math/Interval.hpp"
+
+#include "System/Error.hpp"
+#include "System/Job.hpp"
 
 class Graph {
 public:
+    static constexpr float LineThickness = 4.f; // in pixels
+
     typedef std::function<double(double)> func_explicit_t;
     typedef std::function<sf::Vector2f(double)> func_parametric_t;
-    typedef std::function<sf::Vector2f(double)> sampler_t;
+
+    // encloses the sampled points over a range of the parameter, in the same space the sampler writes to
+    struct Bounds {
+        Math::IntervalValue X;
+        Math::IntervalValue Y;
+    };
+
+    // Samplers write the points of `count` parameters at once, in the space graphs are stored in (screen y points down).
+    // Every kind of graph has its own type, so the sampling loops are compiled for it and m_Sampler is dispatched
+    // on once per pass rather than once per batch. Reentrant samplers may be called from several threads at once.
+
+    // y = f(x) along Axis::Y, x = f(y) along Axis::X; the expression is owned by the graph
+    template <Axis A>
+    struct ExplicitSampler {
+        static constexpr Axis Along = A;
+        static constexpr bool Reentrant = true;
+
+        const Math::Expression* Function;
+
+        void operator()(const double* t, sf::Vector2f* points, std::size_t count) const;
+
+        // lets off screen and straight stretches go without sampling every pixel
+        [[nodiscard]] Bounds Enclose(Math::Interval t) const;
+    };
+
+    // x(t) and y(t) compiled into one program owned by the graph
+    struct ParametricSampler {
+        static constexpr bool Reentrant = true;
+
+        const Math::Expression* Functions;
+
+        void operator()(const double* t, sf::Vector2f* points, std::size_t count) const;
+    };
+
+    template <Axis A>
+    struct ExplicitCallbackSampler {
+        static constexpr Axis Along = A;
+        static constexpr bool Reentrant = false;
+
+        func_explicit_t Function;
+
+        void operator()(const double* t, sf::Vector2f* points, std::size_t count) const;
+    };
+
+    struct ParametricCallbackSampler {
+        static constexpr bool Reentrant = false;
+
+        func_parametric_t Function;
+
+        void operator()(const double* t, sf::Vector2f* points, std::size_t count) const;
+    };
+
+    typedef std::variant<
+        std::monostate,
+        ExplicitSampler<Axis::X>,
+        ExplicitSampler<Axis::Y>,
+        ParametricSampler,
+        ExplicitCallbackSampler<Axis::X>,
+        ExplicitCallbackSampler<Axis::Y>,
+        ParametricCallbackSampler
+    > sampler_t;
+
+    struct SamplingSettings {
+        double Tolerance = 0.001;        // max deviation of a segment from the curve, in world units
+        double MinBendCosine = 0.985;    // refine when consecutive segments turn more than ~10 degrees
+        std::size_t PointBudget = 32768u;
+        unsigned int InitialSegments = 256u;
+        unsigned int MaxDepth = 16u;
+    };
+
+    // the coarsest level each point is kept at, one byte per point; level k keeps the points of every coarser level
+    // and is exact, to a quarter pixel, up to Zoom * 2^k pixels per world unit
+    struct LevelOfDetail {
+        static constexpr uint8_t Never = UINT8_MAX; // points that don't move the line at any zoom
+
+        float Zoom{1.f};
+        uint8_t LevelCount{0u};
+        std::vector<uint8_t> Levels;
+    };
+
+    // what drawing at one LOD level costs, its points along with the vertices of the segments between them; an upper
+    // bound, segments too short to see are never extruded
+    struct LevelMemory {
+        std::size_t Points;
+        std::size_t Bytes;
+    };
+
+    struct Viewport {
+        sf::Vector2f Offset;
+        sf::Vector2u Size;
+        float Zoom;
+    };
+
+    // sampled points along with their LOD levels, what a session stores for each curve
+    struct Curve {
+        std::vector<sf::Vector2f> Points;
+        LevelOfDetail Lod;
+        std::optional<Viewport> View; // the one the points were resampled or traced for, unset when they span the domain
+    };
 
 private:
-    static std::vector<sf::Vector2f> genratePoints(sampler_t sampler, double domainLeft, double domainRight);
+    // batches are spread over the shared thread pool when the sampler is reentrant;
+    // returns nothing once `cancelled` is set, it is checked between refinement passes and batches
+    template <typename Sampler>
+    static std::vector<sf::Vector2f> genratePoints(const Sampler& sampler, double domainLeft, double domainRight, const SamplingSettings& settings, const std::atomic<bool>* cancelled);
+
+    // expressions are the ones the sampler points into, a cached curve is taken as is instead of sampling
+    void setSampler(sampler_t sampler, std::vector<Math::Expression> expressions, double domainLeft, double domainRight, std::optional<Curve> cached, const std::atomic<bool>* cancelled = nullptr);
+
+    std::optional<std::string> generate(const Equation& equation, std::optional<Curve> cached, const std::atomic<bool>* cancelled = nullptr);
+
+    // the graph starts out empty, the contour is traced for each viewport
+    void setField(Math::Contour::field_t field, Math::Contour::bounds_t bounds);
+
+    // the graph has no curve, only the heatmap drawn underneath the others
+    void setHeatmap(Heatmap::field_t field);
+
+    // samples the visible part of an explicit graph's domain on a pixel grid
+    template <typename Sampler>
+    void resample(const Sampler& sampler, const Viewport& viewport);
 
+    // traces the tiles of an implicit graph around the viewport that are not cached yet
+    void updateContour(const Viewport& viewport);
+
+    // a data series reduced to the points of the visible columns, x relative to Origin
+    struct Decimated {
+        std::vector<sf::Vector2f> Points;
+        double Origin;
+    };
+
+    // reduces a data series to the points of the visible columns, on the thread pool for large series
+    void decimate(const Viewport& viewport);
+
+    // simplifies m_Points once into one level per power of two zoom
+    void buildLod();
+
+    // counts the points and segments of every level of m_Lod into m_LodMemory
+    void measureLod();
+
+    // extrudes every segment of the matching LOD level into two triangles, thickness is in pixels at the given zoom
+    void buildGeometry(sf::Color color, float zoom);
+
+    // extrudes the points a stream added since the geometry was last built or extended, at the same zoom;
+    // marks the geometry dirty when the buffer is out of room
+    void appendGeometry(sf::Color color);
+
+    // drains the stream and drops what scrolled out of its window
+    void appendStream();
+
+    // polyline runs separated by a single non-finite point
     std::vector<sf::Vector2f> m_Points;
 
+    SamplingSettings m_Sampling;
+
+    // compiled expressions of the curve, the samplers point into them; moving a vector keeps its elements in place,
+    // so they stay valid as the graph is moved around, but it is only ever replaced as a whole
+    std::vector<Math::Expression> m_Expressions;
+
+    // kept around so explicit graphs can be resampled for the visible part of the domain
+    sampler_t m_Sampler;
+    double m_DomainLeft{-1.0};
+    double m_DomainRight{1.0};
+
+    // samples on a grid of step 2^m_CacheLevel, covering indices [m_CacheFirst, m_CacheFirst + size), empty where not evaluated
+    std::vector<std::optional<sf::Vector2f>> m_CacheSamples;
+    int64_t m_CacheFirst{0};
+    int m_CacheLevel{std::numeric_limits<int>::min()};
+
+    // implicit graphs trace F(x, y) = 0 per viewport, tiles keep their contour segments while they stay near the screen;
+    // the whole cache belongs to one coarse cell size of 2^m_TileLevel
+    Math::Contour::field_t m_Field;
+    Math::Contour::bounds_t m_FieldBounds;
+    std::map<std::pair<int64_t, int64_t>, Math::Contour::Tile> m_Tiles;
+    int m_TileLevel{std::numeric_limits<int>::min()};
+
+    // scalar fields z = f(x, y), following the camera every frame rather than once it settles
+    std::unique_ptr<Heatmap> m_Heatmap;
+
+    // measured data, decimated for each viewport like explicit graphs are resampled; shared so a decimation job can
+    // outlive the graph, the points of the last viewport stay on screen until the job finishes
+    std::shared_ptr<const DataSeries> m_Data;
+    DataSeries::Decimation m_Decimation{DataSeries::Decimation::MinMax};
+    System::Job<Decimated> m_DecimationJob;
+    double m_DataOrigin{0.0}; // world x of x = 0 in m_Points, added in the render transform
+
+    // live samples appended every frame, points before m_StreamFirst have scrolled out of the window
+    std::unique_ptr<Stream> m_Stream;
+    std::size_t m_StreamFirst{0u};
+    std::size_t m_StreamTail{0u}; // points at the end from the bucket still being filled, replaced every frame
+
+    std::optional<Viewport> m_Viewport;
+
+    // world space triangles for one zoom bucket, panning and zooming within it only changes the transform;
+    // the vertex buffer is created lazily on the render thread, the array is used when buffers are unavailable
+    LevelOfDetail m_Lod;
+    std::vector<LevelMemory> m_LodMemory; // one entry per level of m_Lod, coarsest first
+
+    std::unique_ptr<sf::VertexBuffer> m_Geometry;
+    std::vector<uint32_t> m_GeometrySegmentEnds; // index into m_Points where each six vertex segment ends
+    sf::VertexArray m_FallbackGeometry{sf::PrimitiveType::Triangles};
+    int m_GeometryBucket{std::numeric_limits<int>::min()};
+    sf::Color m_GeometryColor;
+    float m_GeometryZoom{1.f};
+    std::size_t m_GeometryPoints{0u}; // points of m_Points the geometry was built or extended for
+    bool m_GeometryDirty{true};
+
+    // parse and sampling running in the background, its result replaces this graph once finished
+    System::Job<System::Error::ResultWrapper<Graph>> m_Job;
+
+    // the equation as typed, empty for graphs set up from callbacks
+    std::string m_Source;
+
     float m_Progress{0.f};
 
 public:
@@ -25,13 +247,79 @@ public:
 
     std::optional<std::string> Generate(const Equation& equation);
 
+    // parses and sets the graph up like Generate, but takes the curve as it is rather than sampling it;
+    // graphs traced or resampled per viewport still do that once they get a viewport other than the curve's
+    std::optional<std::string> Restore(std::string source, Curve curve);
+
+    // parses and samples on the shared thread pool, the graph stays empty until PollGeneration picks up the result
+    void GenerateAsync(std::string source);
+
+    // returns the error once a failed generation finishes
+    std::optional<std::string> PollGeneration();
+
+    [[nodiscard]] inline bool IsPending() const noexcept {
+        return m_Job.IsActive();
+    }
+
+    inline void SetSamplingSettings(const SamplingSettings& settings) noexcept {
+        m_Sampling = settings;
+    }
+
+    [[nodiscard]] inline const SamplingSettings& GetSamplingSettings() const noexcept {
+        return m_Sampling;
+    }
+
+    // loads the file like DataSeries::Load on the shared thread pool, the graph stays empty until PollGeneration
+    // picks up the result and gets its points once it gets a viewport
+    void LoadDataAsync(std::string path);
+
+    // reads samples in the background, see Stream::Open; every frame appends what came in and the graph scrolls so
+    // its newest sample stays at x = 0
+    std::optional<std::string> OpenStream(const std::string& path, double window, Stream::Overflow overflow);
+
+    [[nodiscard]] inline const Stream* GetStream() const noexcept {
+        return m_Stream.get();
+    }
+
+    // takes effect with the next viewport
+    void SetDecimation(DataSeries::Decimation decimation) noexcept;
+
     void SetExplicitCallback(func_explicit_t function, double domainLeft = -1.0, double domainRight = 1.0, Axis axis = Axis::Y);
     void SetParametricCallback(func_parametric_t function, double domainLeft = -1.0, double domainRight = 1.0);
 
+    void UpdateViewport(const Viewport& viewport);
+
+    // every frame, also while the camera moves
+    void UpdateHeatmap(const Viewport& viewport);
+
     void Update(float deltaTime);
     void Render(sf::RenderTarget& target, sf::Color color, sf::Vector2f offset, float zoom);
 
+    // drawn before any graph's curve so every curve stays on top
+    void RenderHeatmap(sf::RenderTarget& target, sf::Vector2f offset, float zoom);
+
+    [[nodiscard]] inline const Heatmap* GetHeatmap() const noexcept {
+        return m_Heatmap.get();
+    }
+
+    [[nodiscard]] inline const std::string& GetSource() const noexcept {
+        return m_Source;
+    }
+
     [[nodiscard]] inline const std::vector<sf::Vector2f>& GetPoints() const {
         return m_Points;
     }
+
+    [[nodiscard]] inline const LevelOfDetail& GetLod() const noexcept {
+        return m_Lod;
+    }
+
+    [[nodiscard]] inline const std::vector<LevelMemory>& GetLodMemory() const noexcept {
+        return m_LodMemory;
+    }
+
+    // the last one the points were resampled or traced for, unset when they don't depend on it
+    [[nodiscard]] inline const std::optional<Viewport>& GetViewport() const noexcept {
+        return m_Viewport;
+    }
 };
\ No newline at end of file
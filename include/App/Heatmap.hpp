@@ -0,0 +1,84 @@
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <memory>
+#include <vector>
+#include <tuple>
+#include <map>
+
+#include "SFML/Graphics.hpp"
+
+#include "System/Job.hpp"
+
+// colours z = f(x, y) behind the graphs, evaluated in world aligned tiles on the shared thread pool;
+// panning only evaluates the tiles coming into view and zooming shows a coarser pass until the zoom comes to rest
+class Heatmap final {
+public:
+    // same shape as Math::Contour::field_t, in the flipped space graphs are stored in
+    typedef std::function<void(const double* x, const double* y, double* values, std::size_t count)> field_t;
+
+    static constexpr unsigned int TileSize = 128u;  // texels along each side of a tile
+    static constexpr int CoarseLevels = 2;          // the pass shown while zooming has 2^CoarseLevels times larger texels
+    static constexpr unsigned int MaxUploadsPerFrame = 16u;
+    static constexpr uint8_t Opacity = 200u;        // lets the grid show through
+
+private:
+    struct Values {
+        std::vector<float> Samples; // row major, non-finite where the field is undefined
+        float Lo;                   // range of the tile without its outermost percent on either side
+        float Hi;
+    };
+
+    struct Tile {
+        System::Job<Values> Job;
+        std::optional<Values> Result;
+
+        // created on the render thread, coloured for m_ColorVersion
+        std::unique_ptr<sf::Texture> Texture;
+        uint64_t ColorVersion{0u};
+    };
+
+    // (level, x, y), a tile of level L covers TileSize * 2^L world units along each side
+    typedef std::tuple<int, int64_t, int64_t> key_t;
+
+    struct TileRange {
+        int64_t Left, Top, Right, Bottom; // inclusive
+    };
+
+    static TileRange visibleTiles(int level, sf::Vector2f offset, sf::Vector2u size, float zoom);
+
+    [[nodiscard]] System::Job<Values> evaluateTile(int level, int64_t tx, int64_t ty) const;
+
+    void uploadTile(Tile& tile);
+
+    field_t m_Field;
+    std::map<key_t, Tile> m_Tiles;
+
+    int m_Level{0};
+    float m_LastZoom{0.f};
+    sf::Vector2f m_LastOffset;
+
+    // values spanning the colour scale, fitted to the screen whenever the camera comes to rest;
+    // stays put while navigating so cached tiles keep their colours
+    float m_RangeLo{0.f};
+    float m_RangeHi{0.f};
+    bool m_HasRange{false};
+    bool m_RangeFitted{false};
+    uint64_t m_ColorVersion{1u};
+
+    std::vector<uint8_t> m_Pixels;
+
+public:
+    explicit Heatmap(field_t field);
+
+    // requests the tiles for the viewport, call once per frame, also while the camera moves
+    void Update(sf::Vector2f offset, sf::Vector2u size, float zoom);
+
+    // uploads a bounded number of finished tiles and draws everything that covers the screen
+    void Render(sf::RenderTarget& target, sf::Vector2f offset, float zoom);
+
+    // evaluates every pixel of an RGBA image right away and blends the colours over it, without tiles or a GL context;
+    // the scale is fitted to the image
+    void Paint(uint8_t* pixels, sf::Vector2u size, sf::Vector2f offset, float zoom) const;
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "SFML/Graphics.hpp"
+
+#include "App/Graph.hpp"
+
+#include "System/Error.hpp"
+#include "System/MappedFile.hpp"
+
+// A saved working set: the equations as they were typed, the camera, and the sampled points of every curve.
+// The points live in a page aligned section at the end of the file that is memory mapped on load, so restoring a
+// curve copies it out of the mapping without evaluating anything and only its pages are ever read from disk.
+// Curves are keyed by a hash of the equation and the sampling settings, a mismatch simply samples again. Curves of
+// graphs resampled or traced per viewport carry that viewport, so they are kept as long as the view is the same.
+class Session final {
+public:
+    static constexpr uint32_t Version = 3u;
+    static constexpr std::size_t PageSize = 4096u;
+
+    struct View {
+        sf::Vector2f Position;
+        float Zoom;
+    };
+
+private:
+    // offsets are from the start of the sample section
+    struct CurveRecord {
+        uint64_t PointsOffset;
+        uint32_t PointCount;
+        uint32_t LevelCount;
+        uint64_t LevelsOffset;
+        float LevelZoom;
+        std::optional<Graph::Viewport> View;
+    };
+
+    System::MappedFile m_File;
+    std::size_t m_SectionOffset{0u};
+
+    std::vector<std::string> m_Equations;
+    View m_View{{0.f, 0.f}, 0.f};
+
+    std::unordered_map<uint64_t, CurveRecord> m_Curves;
+
+public:
+    [[nodiscard]] static uint64_t Key(const std::string& source, const Graph::SamplingSettings& settings);
+
+    // writes every graph set up from an equation, along with the curves of the ones that finished sampling;
+    // the file is replaced only once it is complete
+    static std::optional<std::string> Save(const std::string& path, const View& view, const std::vector<Graph>& graphs);
+
+    static System::Error::ResultWrapper<Session> Load(const std::string& path);
+
+    [[nodiscard]] inline const std::vector<std::string>& GetEquations() const noexcept {
+        return m_Equations;
+    }
+
+    [[nodiscard]] inline const View& GetView() const noexcept {
+        return m_View;
+    }
+
+    // empty when the file holds no curve for this equation under these settings
+    [[nodiscard]] std::optional<Graph::Curve> FindCurve(const std::string& source, const Graph::SamplingSettings& settings) const;
+};
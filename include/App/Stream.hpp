@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SFML/Graphics.hpp"
+
+#include "System/Error.hpp"
+#include "System/RingBuffer.hpp"
+
+// live (t, y) samples read from stdin or a named pipe, one row per line like the rows of a CSV data series; a row of
+// a single number is y at the time it arrived, in seconds since the stream was opened. A reader thread parses them
+// into a ring buffer, the render thread drains it every frame and keeps the lowest and highest sample of every
+// bucket, so a window holds at most two points per bucket however fast the samples come in.
+class Stream final {
+public:
+    enum class Overflow : uint8_t {
+        Block, // the reader waits for room, so a writer filling the pipe waits as well
+        Drop   // samples that don't fit are dropped and counted
+    };
+
+    struct Sample {
+        double T;
+        double Y;
+    };
+
+    // counters since the stream was opened
+    struct Stats {
+        uint64_t Received;  // samples parsed
+        uint64_t Dropped;   // samples lost to a full buffer
+        uint64_t Malformed; // lines without a number
+        uint64_t Stalls;    // times the reader waited for room
+        std::size_t Queued; // samples waiting for the next frame
+        bool Closed;        // the writer is gone
+    };
+
+    static constexpr std::size_t Capacity = 1u << 16;  // samples, about a tenth of a second at 500 kHz
+    static constexpr unsigned int BucketsPerWindow = 2048u;
+
+private:
+    // everything the reader thread touches, it keeps a reference of its own
+    struct Shared {
+        System::RingBuffer<Sample> Ring{Capacity};
+
+        std::atomic<uint64_t> Received{0u};
+        std::atomic<uint64_t> Dropped{0u};
+        std::atomic<uint64_t> Malformed{0u};
+        std::atomic<uint64_t> Stalls{0u};
+
+        std::atomic<bool> Opened{false};
+        std::atomic<bool> Closed{false};
+        std::atomic<bool> Stopping{false};
+    };
+
+    static void readerLoop(std::shared_ptr<Shared> shared, std::string path, Overflow overflow);
+
+    // adds the points of the bucket being filled, as Tail does, and empties it
+    void flushBucket(std::vector<sf::Vector2f>& points);
+
+    std::shared_ptr<Shared> m_Shared;
+    std::thread m_Reader;
+
+    double m_Window;
+    double m_BucketWidth;
+
+    // render thread only: x of the points is t - m_Base, the bucket being filled is [m_Bucket, m_Bucket + 1) widths
+    double m_Base{0.0};
+    bool m_HasBase{false};
+    double m_Latest{0.0};
+
+    int64_t m_Bucket{0};
+    Sample m_Low{0.0, 0.0};
+    Sample m_High{0.0, 0.0};
+    bool m_BucketEmpty{true};
+
+    std::vector<Sample> m_Batch;
+
+    Stream(std::string path, double window, Overflow overflow);
+
+public:
+    ~Stream();
+
+    Stream(const Stream&) = delete;
+    Stream& operator=(const Stream&) = delete;
+
+    // "-" reads stdin, anything else is opened once a writer connects; window is in the units of t
+    static System::Error::ResultWrapper<std::unique_ptr<Stream>> Open(const std::string& path, double window, Overflow overflow);
+
+    // appends the buckets completed since the last call in the flipped space graphs are stored in,
+    // a non-finite y becomes a point that breaks the line; once the writer is gone the last bucket is completed too
+    void Drain(std::vector<sf::Vector2f>& points);
+
+    // appends the points of the bucket being filled in the order they were measured, they are provisional: the caller drops them again before
+    // the next Drain, which may still add samples to that bucket
+    void Tail(std::vector<sf::Vector2f>& points) const;
+
+    // moves x = 0 to about `x`, on a bucket boundary so the buckets stay put; returns by how much x moved
+    double Rebase(double x);
+
+    // x of the newest sample
+    [[nodiscard]] inline double GetLatest() const noexcept {
+        return m_Latest;
+    }
+
+    [[nodiscard]] inline double GetWindow() const noexcept {
+        return m_Window;
+    }
+
+    [[nodiscard]] Stats GetStats() const;
+};
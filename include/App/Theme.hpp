@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+
+#include "SFML/Graphics.hpp"
+
+// shared by the window and images rendered without one
+namespace Theme {
+    constexpr sf::Color BackgroundColor = sf::Color(34u, 34u, 40u);
+    constexpr sf::Color GizmoBaseColor(180u, 180u, 200u);
+    constexpr uint8_t GizmoColorFalloff = 3u;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "Math/Interval.hpp"
+
+namespace Math::Contour {
+    // F(x, y) evaluated for `count` points at once, must be callable from several threads
+    typedef std::function<void(const double* x, const double* y, double* values, std::size_t count)> field_t;
+
+    // encloses F over a box, same threading requirements as the field
+    typedef std::function<Interval(Interval x, Interval y)> bounds_t;
+
+    constexpr int TileCells = 32;   // coarse cells along each side of a tile
+    constexpr int RefineFactor = 8; // fine cells along each side of a coarse cell that may hold the contour
+
+    struct Point {
+        double X;
+        double Y;
+    };
+
+    // an edge of the fine grid, shared by the two cells on either side of it
+    struct EdgeKey {
+        int64_t I;
+        int64_t J;
+        bool Vertical;
+
+        bool operator==(const EdgeKey&) const = default;
+    };
+
+    struct Segment {
+        EdgeKey KeyA;
+        EdgeKey KeyB;
+        Point A;
+        Point B;
+    };
+
+    struct Tile {
+        std::vector<Segment> Segments;
+    };
+
+    // marching squares over the tile (tx, ty) covering [t, t + 1) * TileCells * step on both axes,
+    // coarse cells with a sign change on their corners, or whose bounds reach zero, are traced on a RefineFactor
+    // times finer grid (without bounds a sign change at the center counts as well);
+    // tiles where the bounds keep F away from zero are skipped without evaluating the field
+    [[nodiscard]] Tile TraceTile(const field_t& field, const bounds_t& bounds, double step, int64_t tx, int64_t ty);
+
+    // joins segments sharing an edge into polylines, separated by a single NaN point
+    [[nodiscard]] std::vector<Point> ChainSegments(const std::vector<const Tile*>& tiles);
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "Math/Interval.hpp"
+
+#include "System/Error.hpp"
+
+namespace Math::Jit {
+    class Program;
+}
+
+namespace Math {
+    enum class OpCode : uint8_t {
+        // binary
+        Add,
+        Sub,
+        Mul,
+        Div,
+        Mod,
+        Pow,
+        Atan2,
+        Ncr,
+        Npr,
+
+        // unary
+        Neg,
+        Abs,
+        Acos,
+        Asin,
+        Atan,
+        Ceil,
+        Cos,
+        Cosh,
+        Exp,
+        Fac,
+        Floor,
+        Ln,
+        Log10,
+        Sin,
+        Sinh,
+        Sqrt,
+        Tan,
+        Tanh
+    };
+
+    constexpr std::size_t OpCodeCount = static_cast<std::size_t>(OpCode::Tanh) + 1u;
+
+    constexpr bool IsBinary(OpCode op) noexcept {
+        return op <= OpCode::Npr;
+    }
+
+    double Apply(OpCode op, double a, double b = 0.0);
+
+    // encloses every value the operation takes over the input intervals, along with the chain rule for the slope
+    IntervalValue Apply(OpCode op, const IntervalValue& a, const IntervalValue& b);
+
+    // registers [0, variables) hold the inputs, followed by the constant pool, followed by temporaries
+    struct Instruction {
+        OpCode Op;
+        uint16_t Dst;
+        uint16_t A;
+        uint16_t B;
+    };
+
+    class Expression {
+    public:
+        static constexpr std::size_t BatchSize = 256u;
+
+        // nodes of the sources written out as trees, and of the DAG that is left once shared subexpressions
+        // are merged and the expressions simplified
+        struct NodeCounts {
+            std::size_t Tree;
+            std::size_t Shared;
+        };
+
+        // scratch registers for one thread, the compiled program itself is never written to
+        struct Context {
+            std::vector<double> Registers;
+
+            // one row of BatchSize lanes per register, allocated on the first batch evaluation
+            std::vector<double> BatchRegisters;
+
+            // allocated on the first interval evaluation
+            std::vector<IntervalValue> IntervalRegisters;
+        };
+
+    private:
+        std::vector<Instruction> m_Code;
+
+        // initial register file, zero for inputs and temporaries
+        std::vector<double> m_Registers;
+
+        // register holding the value of each compiled source
+        std::vector<uint16_t> m_Results;
+        uint16_t m_Variables{0u};
+
+        NodeCounts m_NodeCounts{0u, 0u};
+
+        // native batch loop, only present when the expression was compiled with the JIT enabled
+        std::shared_ptr<const Jit::Program> m_Native;
+
+        void evaluateBatch(Context& context, const double* const* inputs, double* const* outputs, std::size_t outputCount, std::size_t count) const;
+
+    public:
+        // tinyexpr compatible grammar, the i-th variable name binds to the i-th input
+        static System::Error::ResultWrapper<Expression> Compile(const std::string& source, const std::vector<std::string>& variables);
+
+        // several sources over the same variables as one program, subexpressions they share are evaluated once
+        static System::Error::ResultWrapper<Expression> Compile(const std::vector<std::string>& sources, const std::vector<std::string>& variables);
+
+        [[nodiscard]] Context CreateContext() const;
+
+        // the first compiled source
+        [[nodiscard]] double Evaluate(Context& context, const double* inputs) const;
+
+        // every compiled source at one point, outputs[i] receives the i-th
+        void Evaluate(Context& context, const double* inputs, double* outputs) const;
+
+        [[nodiscard]] inline double Evaluate(Context& context, double input) const {
+            return Evaluate(context, &input);
+        }
+
+        // inputs[i] points to `count` values of the i-th variable, evaluated BatchSize lanes at a time with SIMD kernels;
+        // writes the first compiled source
+        inline void Evaluate(Context& context, const double* const* inputs, double* outputs, std::size_t count) const {
+            evaluateBatch(context, inputs, &outputs, 1u, count);
+        }
+
+        inline void Evaluate(Context& context, const double* inputs, double* outputs, std::size_t count) const {
+            evaluateBatch(context, &inputs, &outputs, 1u, count);
+        }
+
+        // outputs[i] receives `count` values of the i-th compiled source
+        inline void Evaluate(Context& context, const double* const* inputs, double* const* outputs, std::size_t count) const {
+            evaluateBatch(context, inputs, outputs, m_Results.size(), count);
+        }
+
+        // bounds of the first compiled source over the box where the i-th variable ranges over inputs[i],
+        // the slope is taken along the first variable
+        [[nodiscard]] IntervalValue EvaluateInterval(Context& context, const Interval* inputs) const;
+
+        [[nodiscard]] inline const std::vector<Instruction>& GetCode() const noexcept {
+            return m_Code;
+        }
+
+        [[nodiscard]] inline std::size_t GetRegisterCount() const noexcept {
+            return m_Registers.size();
+        }
+
+        [[nodiscard]] inline std::size_t GetResultCount() const noexcept {
+            return m_Results.size();
+        }
+
+        [[nodiscard]] inline NodeCounts GetNodeCounts() const noexcept {
+            return m_NodeCounts;
+        }
+
+        [[nodiscard]] inline bool IsNative() const noexcept {
+            return m_Native != nullptr;
+        }
+    };
+}
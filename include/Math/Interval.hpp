@@ -0,0 +1,54 @@
+#pragma once
+
+#include <limits>
+
+namespace Math {
+    // closed range of values, empty (Lo > Hi) where the expression is undefined everywhere
+    struct Interval {
+        double Lo;
+        double Hi;
+
+        static constexpr Interval Point(double value) noexcept {
+            return {value, value};
+        }
+
+        static constexpr Interval Empty() noexcept {
+            return {std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()};
+        }
+
+        static constexpr Interval Entire() noexcept {
+            return {-std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()};
+        }
+
+        [[nodiscard]] constexpr bool IsEmpty() const noexcept {
+            return !(Lo <= Hi);
+        }
+
+        [[nodiscard]] constexpr bool Contains(double value) const noexcept {
+            return Lo <= value && value <= Hi;
+        }
+
+        [[nodiscard]] constexpr bool Intersects(double lo, double hi) const noexcept {
+            return Lo <= hi && lo <= Hi;
+        }
+
+        [[nodiscard]] constexpr double Width() const noexcept {
+            return Hi - Lo;
+        }
+    };
+
+    // bounds of an expression and of its derivative over a box of inputs, the slope is only meaningful when continuous
+    struct IntervalValue {
+        Interval Value;
+        Interval Slope;          // with respect to the first variable
+        bool Continuous{true};   // defined everywhere in the box, without jumps or poles
+
+        static constexpr IntervalValue Constant(double value) noexcept {
+            return {Interval::Point(value), Interval::Point(0.0), true};
+        }
+
+        static constexpr IntervalValue Variable(Interval range, bool differentiated) noexcept {
+            return {range, Interval::Point(differentiated ? 1.0 : 0.0), true};
+        }
+    };
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Math/Expression.hpp"
+#include "Math/Simd.hpp"
+
+namespace Math::Jit {
+    // native code for the batch loop of one expression, running every instruction over the register rows
+    // the same way Expression::Evaluate does; arithmetic is kept in vector registers across instructions,
+    // everything else calls the SIMD kernel of the instruction set the program was compiled for
+    class Program final {
+    public:
+        typedef void (*entry_t)(double* rows, std::size_t padded);
+
+    private:
+        void* m_Memory{nullptr};
+        std::size_t m_Size{0u};
+        entry_t m_Entry{nullptr};
+
+    public:
+        Program(void* memory, std::size_t size, std::size_t entryOffset) noexcept;
+        ~Program();
+
+        Program(const Program&) = delete;
+        Program& operator=(const Program&) = delete;
+
+        // rows holds BatchSize lanes per register, padded is a multiple of Simd::MaxWidth
+        inline void Run(double* rows, std::size_t padded) const noexcept {
+            m_Entry(rows, padded);
+        }
+
+        [[nodiscard]] inline std::size_t GetCodeSize() const noexcept {
+            return m_Size;
+        }
+    };
+
+    // x86-64 with the System V calling convention and a way to map executable memory
+    [[nodiscard]] bool IsAvailable() noexcept;
+
+    // off by default, expressions compiled while enabled carry a program and use it for as long as it stays enabled
+    [[nodiscard]] bool IsEnabled() noexcept;
+    void SetEnabled(bool enabled) noexcept;
+
+    // empty when the backend is unavailable, the instruction set is scalar, or the program does not fit the encoder
+    [[nodiscard]] std::shared_ptr<const Program> Compile(const std::vector<Instruction>& code, const std::vector<uint16_t>& results, std::size_t batchSize, Simd::Isa isa);
+}
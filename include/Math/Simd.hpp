@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Math/Expression.hpp"
+
+namespace Math::Simd {
+    enum class Isa : uint8_t {
+        Scalar,
+        Sse2,
+        Avx2
+    };
+
+    // kernels process `count` lanes, which has to be a multiple of MaxWidth; dst may alias a or b
+    typedef void (*kernel_t)(double* dst, const double* a, const double* b, std::size_t count);
+
+    constexpr std::size_t MaxWidth = 4u;
+
+    [[nodiscard]] Isa GetSupportedIsa() noexcept;
+
+    [[nodiscard]] Isa GetIsa() noexcept;
+
+    // clamped to what the cpu supports, mostly useful for benchmarking
+    void SetIsa(Isa isa) noexcept;
+
+    [[nodiscard]] const char* GetIsaName(Isa isa) noexcept;
+
+    [[nodiscard]] kernel_t GetKernel(OpCode op) noexcept;
+}
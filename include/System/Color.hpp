@@ -30,5 +30,30 @@ namespace System {
 
             return sf::Color(static_cast<uint8_t>(r * 255.f), static_cast<uint8_t>(g * 255.f), static_cast<uint8_t>(b * 255.f));
         }
+
+        // perceptually ordered scale from dark blue over teal to yellow, t in [0, 1]
+        constexpr sf::Color Colormap(float t, uint8_t alpha = 255u) {
+            constexpr float Stops[][3] = {
+                {0.267f, 0.005f, 0.329f},
+                {0.230f, 0.322f, 0.546f},
+                {0.128f, 0.567f, 0.551f},
+                {0.369f, 0.789f, 0.383f},
+                {0.993f, 0.906f, 0.144f}
+            };
+
+            constexpr int Last = static_cast<int>(sizeof(Stops) / sizeof(Stops[0])) - 1;
+
+            t = t < 0.f ? 0.f : (t > 1.f ? 1.f : t);
+
+            const float position = t * static_cast<float>(Last);
+            const int i = position >= static_cast<float>(Last) ? Last - 1 : static_cast<int>(position);
+            const float f = position - static_cast<float>(i);
+
+            const auto channel = [&](int c) {
+                return static_cast<uint8_t>((Stops[i][c] + (Stops[i + 1][c] - Stops[i][c]) * f) * 255.f);
+            };
+
+            return sf::Color(channel(0), channel(1), channel(2), alpha);
+        }
     }
 }
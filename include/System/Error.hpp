@@ -23,10 +23,14 @@ namespace System::Error {
             return m_Value.has_value();
         }
 
-        [[nodiscard]] const T& value() const noexcept {
+        [[nodiscard]] const T& value() const& noexcept {
             return m_Value.value();
         }
 
+        [[nodiscard]] T&& value() && noexcept {
+            return std::move(m_Value).value();
+        }
+
         [[nodiscard]] const std::string& error() const noexcept {
             return m_Error;
         }
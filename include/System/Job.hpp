@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <functional>
+
+#include "System/ThreadPool.hpp"
+#include "System/Profiler.hpp"
+
+namespace System {
+    // a task running on the thread pool, dropping or replacing the handle cancels it
+    template <typename T>
+    class Job final {
+    public:
+        typedef std::function<std::optional<T>(const std::atomic<bool>& cancelled)> work_t;
+
+    private:
+        struct State {
+            std::atomic<bool> Cancelled{false};
+            std::atomic<bool> Finished{false};
+
+            // written by the worker before Finished is set
+            std::optional<T> Result;
+        };
+
+        std::shared_ptr<State> m_State;
+
+    public:
+        Job() = default;
+        Job(Job&&) noexcept = default;
+
+        Job& operator=(Job&& other) noexcept {
+            if (this != &other) {
+                Cancel();
+                m_State = std::move(other.m_State);
+            }
+
+            return *this;
+        }
+
+        ~Job() {
+            Cancel();
+        }
+
+        // the work should poll `cancelled` between expensive steps and give up early when it is set
+        [[nodiscard]] static Job Run(ThreadPool& pool, work_t work) {
+            Job job;
+            job.m_State = std::make_shared<State>();
+
+            pool.Submit([state = job.m_State, work = std::move(work)] {
+                PROFILE_SCOPE("Job");
+
+                if (!state->Cancelled.load(std::memory_order_relaxed)) {
+                    state->Result = work(state->Cancelled);
+                }
+
+                state->Finished.store(true, std::memory_order_release);
+            });
+
+            return job;
+        }
+
+        void Cancel() noexcept {
+            if (m_State) {
+                m_State->Cancelled.store(true, std::memory_order_relaxed);
+                m_State.reset();
+            }
+        }
+
+        [[nodiscard]] inline bool IsActive() const noexcept {
+            return m_State != nullptr;
+        }
+
+        [[nodiscard]] inline bool IsFinished() const noexcept {
+            return m_State && m_State->Finished.load(std::memory_order_acquire);
+        }
+
+        // only valid once finished, releases the job; empty if the work gave up
+        [[nodiscard]] std::optional<T> Take() {
+            std::optional<T> result = std::move(m_State->Result);
+            m_State.reset();
+
+            return result;
+        }
+    };
+}
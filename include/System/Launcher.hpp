@@ -13,6 +13,11 @@ public:
         const char* WindowTitle;
         unsigned int WindowStyle;
         bool Fullscreen;
+        const char* SessionPath = nullptr; // opened once resources are loaded
+        std::vector<std::string> DataPaths; // loaded after the session
+        const char* StreamPath = nullptr;   // "-" for stdin, opened last
+        double StreamWindow = 10.0;         // seconds of the stream kept on screen
+        bool StreamDrop = false;            // drop samples rather than block the writer when the stream falls behind
     };
 
     struct WindowState {
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "System/Error.hpp"
+
+namespace System {
+    // a whole file mapped read only, the system reads its pages in on first access
+    class MappedFile final {
+    private:
+        const uint8_t* m_Data{nullptr};
+        std::size_t m_Size{0u};
+
+#ifdef _WIN32
+        void* m_File{nullptr};
+        void* m_Mapping{nullptr};
+#endif
+
+        void close() noexcept;
+
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        // an empty file maps to no data at all
+        static Error::ResultWrapper<MappedFile> Open(const std::string& path);
+
+        [[nodiscard]] inline const uint8_t* GetData() const noexcept {
+            return m_Data;
+        }
+
+        [[nodiscard]] inline std::size_t GetSize() const noexcept {
+            return m_Size;
+        }
+    };
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+// Scoped timers written out as a Chrome trace (chrome://tracing, ui.perfetto.dev).
+// Only compiled in when GRAPH_PLOTTER_PROFILE is defined, otherwise every macro expands to nothing.
+
+#ifdef GRAPH_PLOTTER_PROFILE
+
+#include <cstdint>
+#include <string>
+
+namespace System::Profiler {
+    // microseconds since the first call
+    [[nodiscard]] int64_t Now() noexcept;
+
+    // `name` must outlive the profiler, in practice a string literal
+    void Record(const char* name, int64_t start, int64_t end) noexcept;
+
+    // every span recorded so far by any thread, safe to call while other threads keep recording
+    bool WriteTrace(const std::string& path);
+
+    class Scope final {
+    private:
+        const char* m_Name;
+        int64_t m_Start;
+
+    public:
+        explicit Scope(const char* name) noexcept : m_Name(name), m_Start(Now()) {}
+
+        ~Scope() {
+            Record(m_Name, m_Start, Now());
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+}
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+#define PROFILE_SCOPE(name) const System::Profiler::Scope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_WRITE(path) System::Profiler::WriteTrace(path)
+
+#else
+
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_WRITE(path) ((void)0)
+
+#endif
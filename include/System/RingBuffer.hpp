@@ -0,0 +1,89 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+
+namespace System {
+    // fixed capacity queue without locks for exactly one producer thread and one consumer thread;
+    // the indices only ever grow, their difference is the number of queued items
+    template <typename T>
+    class RingBuffer final {
+    private:
+        // keeps what each side writes on its own cache line
+        static constexpr std::size_t CacheLine = 64u;
+
+        std::unique_ptr<T[]> m_Items;
+        std::size_t m_Mask;
+
+        // next item to pop, written by the consumer, along with its last look at m_Tail
+        alignas(CacheLine) std::atomic<std::size_t> m_Head{0u};
+        std::size_t m_CachedTail{0u};
+
+        // next item to push, written by the producer, along with its last look at m_Head
+        alignas(CacheLine) std::atomic<std::size_t> m_Tail{0u};
+        std::size_t m_CachedHead{0u};
+
+    public:
+        // rounded up to a power of two
+        explicit RingBuffer(std::size_t capacity)
+            : m_Items(std::make_unique<T[]>(std::bit_ceil(std::max<std::size_t>(capacity, 2u)))),
+              m_Mask(std::bit_ceil(std::max<std::size_t>(capacity, 2u)) - 1u) {}
+
+        RingBuffer(const RingBuffer&) = delete;
+        RingBuffer& operator=(const RingBuffer&) = delete;
+
+        // producer only, pushes as many of the items as fit and returns how many
+        std::size_t Push(const T* items, std::size_t count) {
+            const std::size_t tail = m_Tail.load(std::memory_order_relaxed);
+
+            // the consumer's index is only read again once the last look says the buffer is full
+            if (m_Mask + 1u - (tail - m_CachedHead) < count) {
+                m_CachedHead = m_Head.load(std::memory_order_acquire);
+            }
+
+            count = std::min(count, m_Mask + 1u - (tail - m_CachedHead));
+
+            for (std::size_t i = 0u; i < count; ++i) {
+                m_Items[(tail + i) & m_Mask] = items[i];
+            }
+
+            m_Tail.store(tail + count, std::memory_order_release);
+
+            return count;
+        }
+
+        // consumer only, pops up to `count` items and returns how many
+        std::size_t Pop(T* items, std::size_t count) {
+            const std::size_t head = m_Head.load(std::memory_order_relaxed);
+
+            if (m_CachedTail - head < count) {
+                m_CachedTail = m_Tail.load(std::memory_order_acquire);
+            }
+
+            count = std::min(count, m_CachedTail - head);
+
+            for (std::size_t i = 0u; i < count; ++i) {
+                items[i] = m_Items[(head + i) & m_Mask];
+            }
+
+            m_Head.store(head + count, std::memory_order_release);
+
+            return count;
+        }
+
+        // from any thread, already stale by the time it returns
+        [[nodiscard]] std::size_t GetSize() const noexcept {
+            const std::size_t head = m_Head.load(std::memory_order_acquire);
+            const std::size_t tail = m_Tail.load(std::memory_order_acquire);
+
+            return tail - head;
+        }
+
+        [[nodiscard]] inline std::size_t GetCapacity() const noexcept {
+            return m_Mask + 1u;
+        }
+    };
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace System {
+    class ThreadPool final {
+    private:
+        void workerLoop();
+
+        std::vector<std::thread> m_Workers;
+        std::deque<std::function<void()>> m_Tasks;
+
+        std::mutex m_Mutex;
+        std::condition_variable m_Condition;
+
+        bool m_Stopping{false};
+
+    public:
+        explicit ThreadPool(unsigned int workerCount);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // one worker per core besides the calling thread, and never less than one
+        static ThreadPool& Shared();
+
+        void Submit(std::function<void()> task);
+
+        // runs body(begin, end) over [0, count) in chunks of `grain`, the calling thread takes chunks as well,
+        // so it is safe to call from inside a task; returns once every chunk is done
+        void ParallelFor(std::size_t count, std::size_t grain, const std::function<void(std::size_t, std::size_t)>& body);
+
+        [[nodiscard]] inline std::size_t GetWorkerCount() const noexcept {
+            return m_Workers.size();
+        }
+    };
+}
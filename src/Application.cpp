@@ -1,9 +1,15 @@
 #include <iostream>
+#include <algorithm>
 #include <cmath>
+#include <cstdio>
+#include <filesystem>
 
 #include "System/Color.hpp"
+#include "System/Profiler.hpp"
 
 #include "App/Application.hpp"
+#include "App/Session.hpp"
+#include "App/Theme.hpp"
 
 #pragma region Constants
 
@@ -14,12 +20,7 @@ namespace Settings {
     constexpr float MoveImpulse = 2.f;
     constexpr float Ellipson = 0.0001f;
     constexpr float DefaultGizmoScale = 200.f;
-}
-
-namespace Theme {
-    constexpr sf::Color BackgroundColor = sf::Color(34u, 34u, 40u);
-    constexpr sf::Color GizmoBaseColor(180u, 180u, 200u);
-    constexpr uint8_t GizmoColorFalloff = 3u;
+    constexpr float PreviewDebounce = 0.15f; // seconds of no typing before the preview is regenerated
 }
 
 #pragma region Resources
@@ -51,20 +52,45 @@ void Application::HandleKeyPress(sf::Keyboard::Scancode key) {
         m_ShowPreview ^= true;
     }
 
+    else if (
+        key == sf::Keyboard::Scancode::L &&
+        sf::Keyboard::isKeyPressed(sf::Keyboard::Scancode::LControl)
+    ) {
+        m_Decimation = m_Decimation == DataSeries::Decimation::MinMax ? DataSeries::Decimation::Lttb : DataSeries::Decimation::MinMax;
+
+        for (Graph& graph : m_Graphs) {
+            graph.SetDecimation(m_Decimation);
+        }
+    }
+
+    else if (
+        key == sf::Keyboard::Scancode::M &&
+        sf::Keyboard::isKeyPressed(sf::Keyboard::Scancode::LControl)
+    ) {
+        m_ShowMemory ^= true;
+    }
+
+    else if (
+        key == sf::Keyboard::Scancode::S &&
+        sf::Keyboard::isKeyPressed(sf::Keyboard::Scancode::LControl)
+    ) {
+        SaveSession();
+    }
+
+    else if (
+        key == sf::Keyboard::Scancode::O &&
+        sf::Keyboard::isKeyPressed(sf::Keyboard::Scancode::LControl)
+    ) {
+        OpenSession(m_SessionPath);
+    }
+
     else if (m_GettingUserInput) {
         if (key == sf::Keyboard::Scancode::Enter) {
             m_GettingUserInput = false;
             m_RestoringDefaultView = true;
             m_Grabbed = false;
 
-            auto equation = Equation::Parse(m_Textbox.Consume());
-            if (equation) {
-                if (auto error = m_Graphs.emplace_back(!m_ShowPreview).Generate(equation.value())) {
-                    invokeError(error.value());
-                }
-            } else {
-                invokeError(equation.error());
-            }
+            AddEquation(m_Textbox.Consume());
         } else {
             m_Textbox.HandleKeyPress(key);
         }
@@ -76,6 +102,7 @@ void Application::HandleKeyPress(sf::Keyboard::Scancode key) {
     }
 
     else if (key == sf::Keyboard::Scancode::R) {
+        // dropping a pending graph cancels its job
         m_Graphs.clear();
     }
 }
@@ -105,6 +132,78 @@ void Application::HandleMouseWheelScroll(float delta) {
     m_RestoringDefaultView = false;
 }
 
+void Application::AddEquation(std::string source) {
+    // parsed and sampled in the background, the graph shows up once its points are ready
+    m_Graphs.emplace_back(!m_ShowPreview).GenerateAsync(std::move(source));
+}
+
+void Application::AddDataSeries(std::string path) {
+    Graph& graph = m_Graphs.emplace_back(!m_ShowPreview);
+
+    graph.SetDecimation(m_Decimation);
+    graph.LoadDataAsync(std::move(path));
+}
+
+void Application::AddStream(const std::string& path, double window, Stream::Overflow overflow) {
+    Graph& graph = m_Graphs.emplace_back(false);
+
+    if (auto error = graph.OpenStream(path, window, overflow)) {
+        invokeError(error.value());
+        m_Graphs.pop_back();
+    }
+}
+
+void Application::OpenSession(std::string path) {
+    m_SessionPath = std::move(path);
+
+    // nothing saved there yet, the first save creates it
+    if (!std::filesystem::exists(m_SessionPath)) {
+        return;
+    }
+
+    auto result = Session::Load(m_SessionPath);
+
+    if (!result) {
+        invokeError(result.error());
+        return;
+    }
+
+    const Session session = std::move(result).value();
+
+    m_Graphs.clear();
+
+    m_Position = session.GetView().Position;
+    m_GizmoScale = std::max<float>(session.GetView().Zoom, Settings::MinZoom);
+    m_ZoomMomentum = 0.f;
+    m_RestoringDefaultView = false;
+
+    for (const std::string& source : session.GetEquations()) {
+        // cached curves show up right away, the rest is sampled in the background like a typed equation
+        Graph graph(!m_ShowPreview);
+
+        if (auto curve = session.FindCurve(source, graph.GetSamplingSettings())) {
+            if (auto error = graph.Restore(source, std::move(curve.value()))) {
+                invokeError(error.value());
+                continue;
+            }
+
+            m_Graphs.push_back(std::move(graph));
+        } else {
+            AddEquation(source);
+        }
+    }
+}
+
+void Application::SaveSession() {
+    if (auto error = Session::Save(m_SessionPath, {m_Position, m_GizmoScale}, m_Graphs)) {
+        invokeError(error.value());
+    }
+}
+
+bool Application::IsGenerating() const {
+    return std::any_of(m_Graphs.begin(), m_Graphs.end(), [](const Graph& graph) { return graph.IsPending(); });
+}
+
 void Application::invokeError(const std::string& errorMessage) {
     std::cerr << "ERROR: " << errorMessage << std::endl;
 }
@@ -112,12 +211,73 @@ void Application::invokeError(const std::string& errorMessage) {
 #pragma region Update
 
 void Application::Update(float deltaTime) {
+    PROFILE_SCOPE("Application::Update");
+
     updatePanning();
     updateZoom(deltaTime);
     updateViewport(deltaTime);
 
-    for (Graph& graph : m_Graphs) {
-        graph.Update(deltaTime);
+    // resample explicit graphs for the visible slice once the camera comes to rest
+    const bool settled = !m_Grabbed && !m_ZoomMomentum && !m_RestoringDefaultView;
+    const Graph::Viewport viewport{m_Position, m_ViewportSize, m_GizmoScale};
+
+    for (auto it = m_Graphs.begin(); it != m_Graphs.end();) {
+        if (auto error = it->PollGeneration()) {
+            invokeError(error.value());
+            it = m_Graphs.erase(it);
+            continue;
+        }
+
+        if (settled) {
+            it->UpdateViewport(viewport);
+        }
+
+        it->UpdateHeatmap(viewport);
+        it->Update(deltaTime);
+        ++it;
+    }
+
+    updatePreview(deltaTime);
+
+    if (settled) {
+        m_Preview.UpdateViewport(viewport);
+    }
+
+    m_Preview.UpdateHeatmap(viewport);
+}
+
+void Application::updatePreview(float deltaTime) {
+    if (!m_GettingUserInput || !m_ShowPreview) {
+        return;
+    }
+
+    const std::string& source = m_Textbox.GetString();
+
+    if (source != m_PreviewSource) {
+        m_PreviewSource = source;
+        m_PreviewDebounce = Settings::PreviewDebounce;
+
+        if (source.empty()) {
+            m_Preview = Graph(false);
+            m_PendingPreview = Graph(false);
+        }
+    } else if (m_PreviewDebounce > 0.f) {
+        m_PreviewDebounce -= deltaTime;
+
+        // replacing an unfinished job cancels it
+        if (m_PreviewDebounce <= 0.f && !source.empty()) {
+            m_PendingPreview.GenerateAsync(source);
+        }
+    }
+
+    if (m_PendingPreview.IsPending()) {
+        // invalid input keeps showing the last valid preview
+        const bool failed = m_PendingPreview.PollGeneration().has_value();
+
+        if (!m_PendingPreview.IsPending() && !failed) {
+            m_Preview = std::move(m_PendingPreview);
+            m_PendingPreview = Graph(false);
+        }
     }
 }
 
@@ -165,6 +325,36 @@ void Application::updateViewport(float deltaTime) {
 #pragma region Rendering
 
 void Application::renderGizmo(sf::RenderTarget& target) {
+    PROFILE_SCOPE("Application::renderGizmo");
+
+    const sf::Vector2u targetSize = target.getSize();
+    const sf::Vector2f screenCenter = sf::Vector2f(targetSize) * 0.5f;
+    const sf::Vector2f worldCenter = screenCenter + m_Position;
+
+    // every level repeats with the primary spacing, so panning only moves the cached grid by the fractional offset
+    const sf::Vector2f gridOffset = sf::Vector2f(std::fmod(m_Position.x, m_GizmoScale), std::fmod(m_Position.y, m_GizmoScale));
+
+    if (m_GridScale != m_GizmoScale || m_GridSize != targetSize) {
+        m_GridScale = m_GizmoScale;
+        m_GridSize = targetSize;
+
+        buildGizmoGrid(targetSize);
+    }
+
+    target.draw(m_GridGeometry, sf::RenderStates(sf::Transform().translate(gridOffset)));
+
+    // --- Axes ---
+    const sf::Vertex axes[] = {
+        sf::Vertex(sf::Vector2f(worldCenter.x, 0.f), Theme::GizmoBaseColor),
+        sf::Vertex(sf::Vector2f(worldCenter.x, static_cast<float>(targetSize.y)), Theme::GizmoBaseColor),
+        sf::Vertex(sf::Vector2f(0.f, worldCenter.y), Theme::GizmoBaseColor),
+        sf::Vertex(sf::Vector2f(static_cast<float>(targetSize.x), worldCenter.y), Theme::GizmoBaseColor)
+    };
+
+    target.draw(axes, 4u, sf::PrimitiveType::Lines);
+}
+
+void Application::buildGizmoGrid(sf::Vector2u targetSize) {
     const float secondaryZoomFactor = std::clamp((m_GizmoScale - Settings::MinZoom) / (Settings::DefaultGizmoScale - Settings::MinZoom), 0.2f, 1.f);
     const float tertiaryZoomFactor = std::clamp((m_GizmoScale - Settings::DefaultGizmoScale) / Settings::DefaultGizmoScale, 0.f, 1.f);
 
@@ -176,17 +366,14 @@ void Application::renderGizmo(sf::RenderTarget& target) {
     const uint8_t tertiaryAlpha = static_cast<uint8_t>(255u / Theme::GizmoColorFalloff * tertiaryZoomFactor * tertiaryZoomFactor * tertiaryZoomFactor);
     const sf::Color TertiaryColor = sf::Color(Theme::GizmoBaseColor.r, Theme::GizmoBaseColor.g, Theme::GizmoBaseColor.b, tertiaryAlpha);
 
-    const float primaryFrequency = 1.f / m_GizmoScale;
-    const float secondaryFrequency = 2.f * primaryFrequency;
-    const float tertiaryFrequency = 2.f * secondaryFrequency;
-
     const float secondaryScale = m_GizmoScale * 0.5f;
     const float tertiaryScale = secondaryScale * 0.5f;
 
-    const sf::Vector2u targetSize = target.getSize();
-    const sf::Vector2f screenCenter = sf::Vector2f(targetSize) * 0.5f;
-    const sf::Vector2f worldCenter = screenCenter + m_Position;
-    const sf::Vector2f gridOrigin = screenCenter + sf::Vector2f(std::fmod(m_Position.x, m_GizmoScale), std::fmod(m_Position.y, m_GizmoScale));
+    const sf::Vector2f gridOrigin = sf::Vector2f(targetSize) * 0.5f;
+
+    // lines overhang the target by one period so the translated grid still covers it
+    const sf::Vector2f lineStart = sf::Vector2f(-m_GizmoScale, -m_GizmoScale);
+    const sf::Vector2f lineEnd = sf::Vector2f(targetSize) - lineStart;
 
     const int halfLinesX = static_cast<int>(std::ceil(targetSize.x / (2.f * m_GizmoScale))) + 2;
     const int halfLinesY = static_cast<int>(std::ceil(targetSize.y / (2.f * m_GizmoScale))) + 2;
@@ -195,54 +382,47 @@ void Application::renderGizmo(sf::RenderTarget& target) {
     const int halfLinesX3 = static_cast<int>(std::ceil(targetSize.x / (2.f * tertiaryScale))) + 2;
     const int halfLinesY3 = static_cast<int>(std::ceil(targetSize.y / (2.f * tertiaryScale))) + 2;
 
-    sf::VertexArray vertices(sf::PrimitiveType::Lines, 2 * ((2 * halfLinesX3 + 1) + (2 * halfLinesY3 + 1)) + 2 * ((2 * halfLinesX2 + 1) + (2 * halfLinesY2 + 1)) + 2 * ((2 * halfLinesX + 1) + (2 * halfLinesY + 1)) + 4);
+    sf::VertexArray& vertices = m_GridGeometry;
+    vertices.resize(2 * ((2 * halfLinesX3 + 1) + (2 * halfLinesY3 + 1)) * (tertiaryAlpha ? 1 : 0) + 2 * ((2 * halfLinesX2 + 1) + (2 * halfLinesY2 + 1)) + 2 * ((2 * halfLinesX + 1) + (2 * halfLinesY + 1)));
     unsigned int currentIndex = 0u;
 
     // --- Tertiary grid ---
     if (tertiaryAlpha) {
         for (int i = -halfLinesX3; i <= halfLinesX3; ++i) {
             const float x = gridOrigin.x + i * tertiaryScale;
-            vertices[currentIndex++] = sf::Vertex(sf::Vector2f(x, 0.f), TertiaryColor);
-            vertices[currentIndex++] = sf::Vertex(sf::Vector2f(x, static_cast<float>(targetSize.y)), TertiaryColor);
+            vertices[currentIndex++] = sf::Vertex(sf::Vector2f(x, lineStart.y), TertiaryColor);
+            vertices[currentIndex++] = sf::Vertex(sf::Vector2f(x, lineEnd.y), TertiaryColor);
         }
         for (int i = -halfLinesY3; i <= halfLinesY3; ++i) {
             const float y = gridOrigin.y + i * tertiaryScale;
-            vertices[currentIndex++] = sf::Vertex(sf::Vector2f(0.f, y), TertiaryColor);
-            vertices[currentIndex++] = sf::Vertex(sf::Vector2f(static_cast<float>(targetSize.x), y), TertiaryColor);
+            vertices[currentIndex++] = sf::Vertex(sf::Vector2f(lineStart.x, y), TertiaryColor);
+            vertices[currentIndex++] = sf::Vertex(sf::Vector2f(lineEnd.x, y), TertiaryColor);
         }
     }
 
     // --- Secondary grid ---
     for (int i = -halfLinesX2; i <= halfLinesX2; ++i) {
         const float x = gridOrigin.x + i * secondaryScale;
-        vertices[currentIndex++] = sf::Vertex(sf::Vector2f(x, 0.f), SecondaryColor);
-        vertices[currentIndex++] = sf::Vertex(sf::Vector2f(x, static_cast<float>(targetSize.y)), SecondaryColor);
+        vertices[currentIndex++] = sf::Vertex(sf::Vector2f(x, lineStart.y), SecondaryColor);
+        vertices[currentIndex++] = sf::Vertex(sf::Vector2f(x, lineEnd.y), SecondaryColor);
     }
     for (int i = -halfLinesY2; i <= halfLinesY2; ++i) {
         const float y = gridOrigin.y + i * secondaryScale;
-        vertices[currentIndex++] = sf::Vertex(sf::Vector2f(0.f, y), SecondaryColor);
-        vertices[currentIndex++] = sf::Vertex(sf::Vector2f(static_cast<float>(targetSize.x), y), SecondaryColor);
+        vertices[currentIndex++] = sf::Vertex(sf::Vector2f(lineStart.x, y), SecondaryColor);
+        vertices[currentIndex++] = sf::Vertex(sf::Vector2f(lineEnd.x, y), SecondaryColor);
     }
 
     // --- Primary grid ---
     for (int i = -halfLinesX; i <= halfLinesX; ++i) {
         const float x = gridOrigin.x + i * m_GizmoScale;
-        vertices[currentIndex++] = sf::Vertex(sf::Vector2f(x, 0.f), PrimaryColor);
-        vertices[currentIndex++] = sf::Vertex(sf::Vector2f(x, static_cast<float>(targetSize.y)), PrimaryColor);
+        vertices[currentIndex++] = sf::Vertex(sf::Vector2f(x, lineStart.y), PrimaryColor);
+        vertices[currentIndex++] = sf::Vertex(sf::Vector2f(x, lineEnd.y), PrimaryColor);
     }
     for (int i = -halfLinesY; i <= halfLinesY; ++i) {
         const float y = gridOrigin.y + i * m_GizmoScale;
-        vertices[currentIndex++] = sf::Vertex(sf::Vector2f(0.f, y), PrimaryColor);
-        vertices[currentIndex++] = sf::Vertex(sf::Vector2f(static_cast<float>(targetSize.x), y), PrimaryColor);
+        vertices[currentIndex++] = sf::Vertex(sf::Vector2f(lineStart.x, y), PrimaryColor);
+        vertices[currentIndex++] = sf::Vertex(sf::Vector2f(lineEnd.x, y), PrimaryColor);
     }
-
-    // --- Axes ---
-    vertices[currentIndex++] = sf::Vertex(sf::Vector2f(worldCenter.x, 0.f), Theme::GizmoBaseColor);
-    vertices[currentIndex++] = sf::Vertex(sf::Vector2f(worldCenter.x, static_cast<float>(targetSize.y)), Theme::GizmoBaseColor);
-    vertices[currentIndex++] = sf::Vertex(sf::Vector2f(0.f, worldCenter.y), Theme::GizmoBaseColor);
-    vertices[currentIndex++] = sf::Vertex(sf::Vector2f(static_cast<float>(targetSize.x), worldCenter.y), Theme::GizmoBaseColor);
-
-    target.draw(vertices);
 }
 
 void Application::renderColorRect(sf::RenderTarget& target, sf::Color color) {
@@ -258,11 +438,90 @@ void Application::renderColorRect(sf::RenderTarget& target, sf::Color color) {
     target.draw(vertices, 4u, sf::PrimitiveType::TriangleStrip);
 }
 
+void Application::renderStats(sf::RenderTarget& target) {
+    constexpr unsigned int CharacterSize = 16u;
+    constexpr float Margin = 10.f;
+
+    float y = Margin;
+
+    const auto drawLine = [&](const char* line, std::size_t i) {
+        const float hue = static_cast<float>(i) / static_cast<float>(m_Graphs.size());
+
+        sf::Text text(m_Font, line, CharacterSize);
+        text.setFillColor(System::Color::HSLtoRGB(hue, 0.9f, 0.5f));
+        text.setPosition({Margin, y});
+
+        target.draw(text);
+
+        y += CharacterSize * 1.5f;
+    };
+
+    for (std::size_t i = 0u; i < m_Graphs.size(); ++i) {
+        char line[160];
+
+        if (const Stream* stream = m_Graphs[i].GetStream()) {
+            const Stream::Stats stats = stream->GetStats();
+
+            std::snprintf(
+                line, sizeof(line), "%llu received  %llu dropped  %llu malformed  %zu queued  %llu stalls%s",
+                static_cast<unsigned long long>(stats.Received), static_cast<unsigned long long>(stats.Dropped),
+                static_cast<unsigned long long>(stats.Malformed), stats.Queued,
+                static_cast<unsigned long long>(stats.Stalls), stats.Closed ? "  closed" : ""
+            );
+
+            drawLine(line, i);
+        }
+
+        if (m_ShowMemory) {
+            constexpr std::size_t LevelsPerLine = 3u; // fits the line however large the counts get
+
+            const std::vector<sf::Vector2f>& points = m_Graphs[i].GetPoints();
+            const Graph::LevelOfDetail& lod = m_Graphs[i].GetLod();
+            const std::vector<Graph::LevelMemory>& levels = m_Graphs[i].GetLodMemory();
+
+            std::snprintf(
+                line, sizeof(line), "%zu points  %.2f MB  LOD %u levels  %.2f MB of tags",
+                points.size(), points.capacity() * sizeof(sf::Vector2f) / 1048576.0,
+                static_cast<unsigned int>(lod.LevelCount), lod.Levels.size() / 1048576.0
+            );
+
+            drawLine(line, i);
+
+            // what each level draws, coarsest first
+            for (std::size_t first = 0u; first < levels.size(); first += LevelsPerLine) {
+                int length = 0;
+
+                for (std::size_t k = first; k < std::min(first + LevelsPerLine, levels.size()); ++k) {
+                    length += std::snprintf(
+                        line + length, sizeof(line) - static_cast<std::size_t>(length), "  L%zu %zu points %.1f KB",
+                        k, levels[k].Points, levels[k].Bytes / 1024.0
+                    );
+                }
+
+                drawLine(line, i);
+            }
+        }
+    }
+}
+
 void Application::Render(sf::RenderTarget& target) {
+    PROFILE_SCOPE("Application::Render");
+
+    m_ViewportSize = target.getSize();
+
     target.clear(Theme::BackgroundColor);
 
     renderGizmo(target);
 
+    // scalar fields go underneath every curve
+    for (Graph& graph : m_Graphs) {
+        graph.RenderHeatmap(target, m_Position, m_GizmoScale);
+    }
+
+    if (m_GettingUserInput && m_ShowPreview) {
+        m_Preview.RenderHeatmap(target, m_Position, m_GizmoScale);
+    }
+
     for (std::size_t i = 0u; i < m_Graphs.size(); ++i) {
         const float hue = static_cast<float>(i) / static_cast<float>(m_Graphs.size());
         const sf::Color graphColor = System::Color::HSLtoRGB(hue, 0.9f, 0.5f);
@@ -270,20 +529,13 @@ void Application::Render(sf::RenderTarget& target) {
         m_Graphs[i].Render(target, graphColor, m_Position, m_GizmoScale);
     }
 
+    renderStats(target);
+
     if (m_GettingUserInput) {
         if (m_ShowPreview) {
-            const std::string textboxString = m_Textbox.GetString();
-
-            if (!textboxString.empty()) {
-                Graph graph(false);
-
-                auto equation = Equation::Parse(textboxString);
-                if (equation && !graph.Generate(equation.value())) {
-                    const float hue = m_Graphs.size() / static_cast<float>(m_Graphs.size() + 1);
-                    const sf::Color color = System::Color::HSLtoRGB(hue, 0.9f, 0.5f);
-                    graph.Render(target, color, m_Position, m_GizmoScale);
-                }
-            }
+            const float hue = m_Graphs.size() / static_cast<float>(m_Graphs.size() + 1);
+            const sf::Color color = System::Color::HSLtoRGB(hue, 0.9f, 0.5f);
+            m_Preview.Render(target, color, m_Position, m_GizmoScale);
         }
 
         renderColorRect(target, sf::Color(25u, 25u, 35u, 150));
@@ -0,0 +1,406 @@
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+
+#include "App/Batch.hpp"
+#include "App/Equation.hpp"
+#include "App/Theme.hpp"
+
+#include "System/Color.hpp"
+#include "System/Profiler.hpp"
+#include "System/ThreadPool.hpp"
+
+#pragma region Options
+
+System::Error::ResultWrapper<sf::Vector2u> Batch::ParseSize(const std::string& spec) {
+    unsigned int width = 0u;
+    unsigned int height = 0u;
+
+    const char* const end = spec.data() + spec.size();
+    const auto [widthEnd, widthError] = std::from_chars(spec.data(), end, width);
+
+    if (widthError != std::errc() || widthEnd == end || *widthEnd != 'x') {
+        return System::Error::failure<sf::Vector2u>("The image size has to look like 640x360");
+    }
+
+    const auto [heightEnd, heightError] = std::from_chars(widthEnd + 1, end, height);
+
+    if (heightError != std::errc() || heightEnd != end) {
+        return System::Error::failure<sf::Vector2u>("The image size has to look like 640x360");
+    }
+
+    if (!width || !height || width > MaxImageSide || height > MaxImageSide) {
+        return System::Error::failure<sf::Vector2u>("Images are between 1 and " + std::to_string(MaxImageSide) + " pixels along each side");
+    }
+
+    return System::Error::success(sf::Vector2u(width, height));
+}
+
+System::Error::ResultWrapper<Batch::View> Batch::ParseView(const std::string& spec, sf::Vector2u size) {
+    double bounds[4];
+    const char* begin = spec.data();
+    const char* const end = spec.data() + spec.size();
+
+    for (unsigned int i = 0u; i < 4u; ++i) {
+        const auto [next, error] = std::from_chars(begin, end, bounds[i]);
+
+        if (error != std::errc() || (i < 3u ? next == end || *next != ',' : next != end)) {
+            return System::Error::failure<View>("The view has to look like left,right,bottom,top");
+        }
+
+        begin = next + 1;
+    }
+
+    const auto [left, right, bottom, top] = bounds;
+
+    if (!(left < right) || !(bottom < top) || !std::isfinite(right - left) || !std::isfinite(top - bottom)) {
+        return System::Error::failure<View>("The view has to span a finite range from left to right and from bottom to top");
+    }
+
+    View view;
+    view.Size = size;
+    view.Center = sf::Vector2f(static_cast<float>(0.5 * (left + right)), static_cast<float>(0.5 * (bottom + top)));
+    view.Zoom = static_cast<float>(std::min(size.x / (right - left), size.y / (top - bottom)));
+
+    // graphs are stored in floats
+    if (!std::isfinite(view.Center.x) || !std::isfinite(view.Center.y) || !std::isfinite(view.Zoom) || !(view.Zoom > 0.f)) {
+        return System::Error::failure<View>("The view is too far out or too small to be drawn");
+    }
+
+    return System::Error::success(view);
+}
+
+#pragma region Drawing
+
+Graph::Viewport Batch::viewport(const View& view) {
+    // the offset moves the origin away from the centre of the screen, graphs are stored with y pointing down
+    return {
+        sf::Vector2f(-view.Center.x * view.Zoom, view.Center.y * view.Zoom),
+        view.Size,
+        view.Zoom
+    };
+}
+
+void BlendPixel(std::vector<uint8_t>& pixels, std::size_t index, sf::Color color, float alpha) {
+    uint8_t* pixel = pixels.data() + index * 4u;
+
+    pixel[0] = static_cast<uint8_t>(pixel[0] + (color.r - pixel[0]) * alpha + 0.5f);
+    pixel[1] = static_cast<uint8_t>(pixel[1] + (color.g - pixel[1]) * alpha + 0.5f);
+    pixel[2] = static_cast<uint8_t>(pixel[2] + (color.b - pixel[2]) * alpha + 0.5f);
+}
+
+void Batch::drawGrid(Canvas& canvas, const View& view) {
+    // lines are a power of two world units apart and never closer than this many pixels
+    constexpr double MinSpacing = 48.0;
+
+    const Graph::Viewport port = viewport(view);
+    const sf::Vector2u size = canvas.Size;
+
+    const double step = std::exp2(std::ceil(std::log2(MinSpacing / view.Zoom)));
+
+    const double originX = 0.5 * size.x + port.Offset.x;
+    const double originY = 0.5 * size.y + port.Offset.y;
+
+    const auto vertical = [&](double x, sf::Color color) {
+        const double column = std::floor(originX + x * view.Zoom);
+
+        if (column >= 0.0 && column < size.x) {
+            for (unsigned int row = 0u; row < size.y; ++row) {
+                BlendPixel(canvas.Pixels, static_cast<std::size_t>(row) * size.x + static_cast<std::size_t>(column), color, color.a / 255.f);
+            }
+        }
+    };
+
+    const auto horizontal = [&](double y, sf::Color color) {
+        const double row = std::floor(originY + y * view.Zoom);
+
+        if (row >= 0.0 && row < size.y) {
+            for (unsigned int column = 0u; column < size.x; ++column) {
+                BlendPixel(canvas.Pixels, static_cast<std::size_t>(row) * size.x + column, color, color.a / 255.f);
+            }
+        }
+    };
+
+    constexpr sf::Color PrimaryColor(Theme::GizmoBaseColor.r, Theme::GizmoBaseColor.g, Theme::GizmoBaseColor.b, 255u / Theme::GizmoColorFalloff);
+    constexpr sf::Color SecondaryColor(Theme::GizmoBaseColor.r, Theme::GizmoBaseColor.g, Theme::GizmoBaseColor.b, 255u / Theme::GizmoColorFalloff / 3u);
+
+    // half steps in the flipped space from the left and top edges of the image to its right and bottom edges, even ones
+    // are primary lines; counted rather than stepped so views far from the origin still end
+    const auto lines = [&](double origin, unsigned int extent, const auto& draw) {
+        const double first = std::floor(-origin / view.Zoom / step * 2.0);
+        const double count = std::ceil((extent - origin) / view.Zoom / step * 2.0) - first;
+
+        for (double k = 0.0; k <= count; ++k) {
+            const double i = first + k;
+            draw(i * step * 0.5, std::fmod(i, 2.0) == 0.0 ? PrimaryColor : SecondaryColor);
+        }
+    };
+
+    lines(originX, size.x, vertical);
+    lines(originY, size.y, horizontal);
+
+    vertical(0.0, Theme::GizmoBaseColor);
+    horizontal(0.0, Theme::GizmoBaseColor);
+}
+
+// clips the segment to the box, false when nothing of it is inside
+bool ClipSegment(double& ax, double& ay, double& bx, double& by, double low, double highX, double highY) {
+    double t0 = 0.0;
+    double t1 = 1.0;
+
+    const double dx = bx - ax;
+    const double dy = by - ay;
+
+    const double p[4] = {-dx, dx, -dy, dy};
+    const double q[4] = {ax - low, highX - ax, ay - low, highY - ay};
+
+    for (unsigned int i = 0u; i < 4u; ++i) {
+        if (p[i] == 0.0) {
+            if (q[i] < 0.0) {
+                return false;
+            }
+
+            continue;
+        }
+
+        const double t = q[i] / p[i];
+
+        if (p[i] < 0.0) {
+            t0 = std::max(t0, t);
+        } else {
+            t1 = std::min(t1, t);
+        }
+
+        if (t0 > t1) {
+            return false;
+        }
+    }
+
+    bx = ax + t1 * dx;
+    by = ay + t1 * dy;
+    ax = ax + t0 * dx;
+    ay = ay + t0 * dy;
+
+    return true;
+}
+
+void Batch::drawCurve(Canvas& canvas, const View& view, const std::vector<sf::Vector2f>& points, sf::Color color) {
+    // long segments are stamped in pieces so their bounding boxes stay small
+    constexpr double MaxPieceLength = 16.0;
+
+    const Graph::Viewport port = viewport(view);
+    const sf::Vector2u size = canvas.Size;
+
+    const double radius = Graph::LineThickness * 0.5;
+    const double reach = radius + 1.0;
+
+    // fully covered within the inner distance, partially up to the outer one
+    const double innerSquare = (radius - 0.5) * (radius - 0.5);
+    const double outerSquare = (radius + 0.5) * (radius + 0.5);
+
+    const double originX = 0.5 * size.x + port.Offset.x;
+    const double originY = 0.5 * size.y + port.Offset.y;
+
+    std::fill(canvas.Coverage.begin(), canvas.Coverage.end(), 0.f);
+
+    long touchedLeft = static_cast<long>(size.x);
+    long touchedTop = static_cast<long>(size.y);
+    long touchedRight = -1;
+    long touchedBottom = -1;
+
+    // coverage of a pixel is how much of it the thick line would cover, taken at its centre
+    const auto stamp = [&](double ax, double ay, double bx, double by) {
+        const long left = std::max(0l, static_cast<long>(std::floor(std::min(ax, bx) - reach)));
+        const long top = std::max(0l, static_cast<long>(std::floor(std::min(ay, by) - reach)));
+        const long right = std::min(static_cast<long>(size.x) - 1, static_cast<long>(std::ceil(std::max(ax, bx) + reach)));
+        const long bottom = std::min(static_cast<long>(size.y) - 1, static_cast<long>(std::ceil(std::max(ay, by) + reach)));
+
+        const double dx = bx - ax;
+        const double dy = by - ay;
+        const double lengthSquare = dx * dx + dy * dy;
+
+        for (long row = top; row <= bottom; ++row) {
+            for (long column = left; column <= right; ++column) {
+                const double px = column + 0.5 - ax;
+                const double py = row + 0.5 - ay;
+
+                const double t = lengthSquare > 0.0 ? std::clamp((px * dx + py * dy) / lengthSquare, 0.0, 1.0) : 0.0;
+                const double ex = px - t * dx;
+                const double ey = py - t * dy;
+                const double distanceSquare = ex * ex + ey * ey;
+
+                // most of the box is clear of the line
+                if (distanceSquare >= outerSquare) {
+                    continue;
+                }
+
+                const float coverage = distanceSquare <= innerSquare ? 1.f : static_cast<float>(radius + 0.5 - std::sqrt(distanceSquare));
+                float& covered = canvas.Coverage[static_cast<std::size_t>(row) * size.x + static_cast<std::size_t>(column)];
+
+                covered = std::max(covered, coverage);
+            }
+        }
+
+        touchedLeft = std::min(touchedLeft, left);
+        touchedTop = std::min(touchedTop, top);
+        touchedRight = std::max(touchedRight, right);
+        touchedBottom = std::max(touchedBottom, bottom);
+    };
+
+    for (std::size_t i = 1u; i < points.size(); ++i) {
+        const sf::Vector2f p0 = points[i - 1u];
+        const sf::Vector2f p1 = points[i];
+
+        if (!std::isfinite(p0.x) || !std::isfinite(p0.y) || !std::isfinite(p1.x) || !std::isfinite(p1.y)) {
+            continue;
+        }
+
+        double ax = originX + p0.x * static_cast<double>(view.Zoom);
+        double ay = originY + p0.y * static_cast<double>(view.Zoom);
+        double bx = originX + p1.x * static_cast<double>(view.Zoom);
+        double by = originY + p1.y * static_cast<double>(view.Zoom);
+
+        if (!ClipSegment(ax, ay, bx, by, -reach, size.x + reach, size.y + reach)) {
+            continue;
+        }
+
+        const double pieces = std::max(1.0, std::ceil(std::hypot(bx - ax, by - ay) / MaxPieceLength));
+
+        for (double piece = 0.0; piece < pieces; ++piece) {
+            const double t0 = piece / pieces;
+            const double t1 = (piece + 1.0) / pieces;
+
+            stamp(ax + (bx - ax) * t0, ay + (by - ay) * t0, ax + (bx - ax) * t1, ay + (by - ay) * t1);
+        }
+    }
+
+    for (long row = touchedTop; row <= touchedBottom; ++row) {
+        for (long column = touchedLeft; column <= touchedRight; ++column) {
+            const std::size_t index = static_cast<std::size_t>(row) * size.x + static_cast<std::size_t>(column);
+
+            if (canvas.Coverage[index] > 0.f) {
+                BlendPixel(canvas.Pixels, index, color, canvas.Coverage[index]);
+            }
+        }
+    }
+}
+
+#pragma region Jobs
+
+std::optional<std::string> Batch::renderOne(const std::string& source, const View& view, Canvas& canvas, const std::string& path) {
+    PROFILE_SCOPE("Batch::renderOne");
+
+    auto equation = Equation::Parse(source);
+
+    if (!equation) {
+        return equation.error();
+    }
+
+    Graph graph(false);
+
+    if (auto error = graph.Generate(equation.value())) {
+        return error;
+    }
+
+    // explicit graphs are resampled and implicit ones traced for the view, right away
+    graph.UpdateViewport(viewport(view));
+
+    const std::size_t pixelCount = static_cast<std::size_t>(view.Size.x) * view.Size.y;
+
+    canvas.Size = view.Size;
+    canvas.Pixels.resize(pixelCount * 4u);
+    canvas.Coverage.resize(pixelCount);
+
+    for (std::size_t i = 0u; i < pixelCount; ++i) {
+        canvas.Pixels[i * 4u + 0u] = Theme::BackgroundColor.r;
+        canvas.Pixels[i * 4u + 1u] = Theme::BackgroundColor.g;
+        canvas.Pixels[i * 4u + 2u] = Theme::BackgroundColor.b;
+        canvas.Pixels[i * 4u + 3u] = 255u;
+    }
+
+    drawGrid(canvas, view);
+
+    if (const Heatmap* heatmap = graph.GetHeatmap()) {
+        const Graph::Viewport port = viewport(view);
+        heatmap->Paint(canvas.Pixels.data(), port.Size, port.Offset, port.Zoom);
+    }
+
+    // the colour of the first graph in the window
+    drawCurve(canvas, view, graph.GetPoints(), System::Color::HSLtoRGB(0.f, 0.9f, 0.5f));
+
+    const sf::Image image(view.Size, canvas.Pixels.data());
+
+    if (!image.saveToFile(path)) {
+        return "Couldn't write " + path;
+    }
+
+    return std::nullopt;
+}
+
+System::Error::ResultWrapper<Batch::Summary> Batch::Run(const std::string& equationsPath, const std::string& directory, const View& view) {
+    PROFILE_SCOPE("Batch::Run");
+
+    std::ifstream file(equationsPath);
+
+    if (!file) {
+        return System::Error::failure<Summary>("Couldn't open " + equationsPath);
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    if (error) {
+        return System::Error::failure<Summary>("Couldn't create " + directory + ": " + error.message());
+    }
+
+    // (line number, equation), a few bytes per job however large the images are
+    std::vector<std::pair<std::size_t, std::string>> jobs;
+    std::size_t lineNumber = 0u;
+
+    for (std::string line; std::getline(file, line);) {
+        ++lineNumber;
+
+        const std::size_t first = line.find_first_not_of(" \t\r");
+
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+
+        line.erase(line.find_last_not_of(" \t\r") + 1u);
+        line.erase(0u, first);
+
+        jobs.emplace_back(lineNumber, std::move(line));
+    }
+
+    std::atomic<std::size_t> failed{0u};
+    std::mutex reportMutex;
+
+    // one job per chunk, the images of the chunks running at the same time are all there is in memory
+    System::ThreadPool::Shared().ParallelFor(jobs.size(), 1u, [&](std::size_t begin, std::size_t end) {
+        Canvas canvas;
+
+        for (std::size_t i = begin; i < end; ++i) {
+            const auto& [number, source] = jobs[i];
+
+            char name[32];
+            std::snprintf(name, sizeof(name), "%05zu.png", number);
+
+            const std::string path = (std::filesystem::path(directory) / name).string();
+
+            if (auto message = renderOne(source, view, canvas, path)) {
+                failed.fetch_add(1u, std::memory_order_relaxed);
+
+                std::lock_guard lock(reportMutex);
+                std::cerr << "ERROR: " << equationsPath << ":" << number << ": " << message.value() << std::endl;
+            }
+        }
+    });
+
+    return System::Error::success(Summary{jobs.size() - failed.load(), failed.load()});
+}
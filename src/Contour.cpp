@@ -0,0 +1,369 @@
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <unordered_map>
+
+#include "Math/Contour.hpp"
+
+struct EdgeKeyHash {
+    std::size_t operator()(const Math::Contour::EdgeKey& key) const noexcept {
+        const uint64_t h = static_cast<uint64_t>(key.I) * 0x9E3779B97F4A7C15ull ^ static_cast<uint64_t>(key.J) * 0xC2B2AE3D27D4EB4Full;
+        return static_cast<std::size_t>(h ^ (h >> 29u) ^ static_cast<uint64_t>(key.Vertical));
+    }
+};
+
+// crossing on one of the four edges of the fine cell (i, j):
+// 0 bottom a-b, 1 right b-c, 2 top d-c, 3 left a-d, with a at (i, j) and c at (i + 1, j + 1)
+struct Crossing {
+    Math::Contour::EdgeKey Key;
+    Math::Contour::Point Position;
+    double Limit; // smaller magnitude of the two values on the edge
+};
+
+Crossing EdgeCrossing(int edge, int64_t i, int64_t j, double step, const double* corners) {
+    const double a = corners[0], b = corners[1], c = corners[2], d = corners[3];
+
+    const auto lerp = [](double v0, double v1) {
+        return v0 == v1 ? 0.5 : v0 / (v0 - v1);
+    };
+
+    const double x = static_cast<double>(i) * step;
+    const double y = static_cast<double>(j) * step;
+
+    const auto limit = [](double v0, double v1) {
+        return std::min(std::fabs(v0), std::fabs(v1));
+    };
+
+    switch (edge) {
+        case 0: return {{i, j, false}, {x + lerp(a, b) * step, y}, limit(a, b)};
+        case 1: return {{i + 1, j, true}, {x + step, y + lerp(b, c) * step}, limit(b, c)};
+        case 2: return {{i, j + 1, false}, {x + lerp(d, c) * step, y + step}, limit(d, c)};
+        default: return {{i, j, true}, {x, y + lerp(a, d) * step}, limit(a, d)};
+    }
+}
+
+// pairs of edges crossed by the contour for each corner sign pattern, -1 terminated; the saddles 5 and 10 are
+// resolved separately with the value at the center of the cell
+constexpr int EdgeTable[16][5] = {
+    {-1}, {3, 0, -1}, {0, 1, -1}, {3, 1, -1},
+    {1, 2, -1}, {-1}, {0, 2, -1}, {3, 2, -1},
+    {3, 2, -1}, {0, 2, -1}, {-1}, {1, 2, -1},
+    {3, 1, -1}, {0, 1, -1}, {3, 0, -1}, {-1}
+};
+
+// appends the segments of one cell, and the limits of both their ends to `limits`
+void TraceCell(std::vector<Math::Contour::Segment>& segments, std::vector<double>& limits, int64_t i, int64_t j, double step, const double* corners) {
+    // an infinite corner sits on a pole, there is nothing to interpolate against
+    for (int k = 0; k < 4; ++k) {
+        if (!std::isfinite(corners[k])) {
+            return;
+        }
+    }
+
+    const int index = (corners[0] > 0.0) | (corners[1] > 0.0) << 1 | (corners[2] > 0.0) << 2 | (corners[3] > 0.0) << 3;
+
+    int edges[4];
+    int count = 0;
+
+    if (index == 5 || index == 10) {
+        // positive center joins the positive corners, cut around the negative ones instead
+        const bool centerPositive = corners[0] + corners[1] + corners[2] + corners[3] > 0.0;
+        const bool cutAroundB = (index == 5) == centerPositive;
+
+        const int saddle[2][4] = {{3, 0, 1, 2}, {0, 1, 2, 3}};
+        const int* pairs = saddle[cutAroundB];
+
+        for (int k = 0; k < 4; ++k) {
+            edges[count++] = pairs[k];
+        }
+    } else {
+        for (const int* edge = EdgeTable[index]; *edge >= 0; ++edge) {
+            edges[count++] = *edge;
+        }
+    }
+
+    for (int k = 0; k < count; k += 2) {
+        const Crossing from = EdgeCrossing(edges[k], i, j, step, corners);
+        const Crossing to = EdgeCrossing(edges[k + 1], i, j, step, corners);
+
+        segments.push_back({from.Key, to.Key, from.Position, to.Position});
+        limits.push_back(from.Limit);
+        limits.push_back(to.Limit);
+    }
+}
+
+Math::Contour::Tile Math::Contour::TraceTile(const field_t& field, const bounds_t& bounds, double step, int64_t tx, int64_t ty) {
+    constexpr int Nodes = TileCells + 1;
+    constexpr int FineNodes = RefineFactor + 1;
+
+    const double fineStep = step / RefineFactor;
+
+    if (bounds) {
+        const double size = step * TileCells;
+        const double x = static_cast<double>(tx) * size;
+        const double y = static_cast<double>(ty) * size;
+
+        const Interval range = bounds({x, x + size}, {y, y + size});
+
+        // the same split as the corner test below, positive against the rest
+        if (range.IsEmpty() || range.Lo > 0.0 || range.Hi <= 0.0) {
+            return {};
+        }
+    }
+
+    // coarse corners of the whole tile in one batch
+    std::vector<double> xs(Nodes * Nodes);
+    std::vector<double> ys(Nodes * Nodes);
+    std::vector<double> values(Nodes * Nodes);
+
+    for (int v = 0; v < Nodes; ++v) {
+        for (int u = 0; u < Nodes; ++u) {
+            // computed from global fine indices so neighbouring tiles agree on shared nodes bit for bit
+            xs[v * Nodes + u] = static_cast<double>((tx * TileCells + u) * RefineFactor) * fineStep;
+            ys[v * Nodes + u] = static_cast<double>((ty * TileCells + v) * RefineFactor) * fineStep;
+        }
+    }
+
+    field(xs.data(), ys.data(), values.data(), values.size());
+
+    // without bounds the center of every cell is sampled as well, it is a node of the fine grid
+    std::vector<double> centers;
+
+    if (!bounds) {
+        constexpr int Cells = TileCells * TileCells;
+
+        std::vector<double> cx(Cells);
+        std::vector<double> cy(Cells);
+        centers.resize(Cells);
+
+        for (int v = 0; v < TileCells; ++v) {
+            for (int u = 0; u < TileCells; ++u) {
+                cx[v * TileCells + u] = static_cast<double>((tx * TileCells + u) * RefineFactor + RefineFactor / 2) * fineStep;
+                cy[v * TileCells + u] = static_cast<double>((ty * TileCells + v) * RefineFactor + RefineFactor / 2) * fineStep;
+            }
+        }
+
+        field(cx.data(), cy.data(), centers.data(), centers.size());
+    }
+
+    // a small closed contour or a tangent touch fits between the corners of a cell without changing their signs,
+    // the bounds still reach zero there; they are taken over blocks halved down to single cells, so only the
+    // neighbourhood of the contour costs more than one enclosure
+    std::vector<bool> reaches(TileCells * TileCells, false);
+
+    if (bounds) {
+        const auto enclose = [&](const auto& self, int u0, int v0, int size) -> void {
+            const Interval range = bounds(
+                {xs[v0 * Nodes + u0], xs[v0 * Nodes + u0 + size]}, {ys[v0 * Nodes + u0], ys[(v0 + size) * Nodes + u0]}
+            );
+
+            if (range.IsEmpty() || range.Lo > 0.0 || range.Hi <= 0.0) {
+                return;
+            }
+
+            if (size == 1) {
+                reaches[v0 * TileCells + u0] = true;
+                return;
+            }
+
+            const int half = size / 2;
+
+            for (int k = 0; k < 4; ++k) {
+                self(self, u0 + (k & 1) * half, v0 + (k >> 1) * half, half);
+            }
+        };
+
+        // the whole tile was enclosed above already
+        for (int k = 0; k < 4; ++k) {
+            enclose(enclose, (k & 1) * TileCells / 2, (k >> 1) * TileCells / 2, TileCells / 2);
+        }
+    }
+
+    std::vector<int> flagged;
+
+    for (int v = 0; v < TileCells; ++v) {
+        for (int u = 0; u < TileCells; ++u) {
+            const double corners[] = {
+                values[v * Nodes + u], values[v * Nodes + u + 1],
+                values[(v + 1) * Nodes + u + 1], values[(v + 1) * Nodes + u]
+            };
+
+            bool positive = false;
+            bool other = false;
+
+            for (double corner : corners) {
+                positive |= corner > 0.0;
+                other |= corner <= 0.0;
+            }
+
+            const int cell = v * TileCells + u;
+            bool crossed = positive && other;
+
+            if (positive != other) {
+                crossed = bounds ? reaches[cell] : positive ? centers[cell] <= 0.0 : centers[cell] > 0.0;
+            }
+
+            if (crossed) {
+                flagged.push_back(cell);
+            }
+        }
+    }
+
+    Tile tile;
+
+    if (flagged.empty()) {
+        return tile;
+    }
+
+    // every flagged cell on the fine grid, again in one batch
+    const std::size_t perCell = FineNodes * FineNodes;
+
+    xs.resize(flagged.size() * perCell);
+    ys.resize(flagged.size() * perCell);
+    values.resize(flagged.size() * perCell);
+
+    for (std::size_t f = 0u; f < flagged.size(); ++f) {
+        const int64_t i0 = (tx * TileCells + flagged[f] % TileCells) * RefineFactor;
+        const int64_t j0 = (ty * TileCells + flagged[f] / TileCells) * RefineFactor;
+
+        for (int v = 0; v < FineNodes; ++v) {
+            for (int u = 0; u < FineNodes; ++u) {
+                xs[f * perCell + v * FineNodes + u] = static_cast<double>(i0 + u) * fineStep;
+                ys[f * perCell + v * FineNodes + u] = static_cast<double>(j0 + v) * fineStep;
+            }
+        }
+    }
+
+    field(xs.data(), ys.data(), values.data(), values.size());
+
+    std::vector<double> limits;
+
+    for (std::size_t f = 0u; f < flagged.size(); ++f) {
+        const int64_t i0 = (tx * TileCells + flagged[f] % TileCells) * RefineFactor;
+        const int64_t j0 = (ty * TileCells + flagged[f] / TileCells) * RefineFactor;
+
+        const double* cell = values.data() + f * perCell;
+
+        for (int v = 0; v < RefineFactor; ++v) {
+            for (int u = 0; u < RefineFactor; ++u) {
+                const double corners[] = {
+                    cell[v * FineNodes + u], cell[v * FineNodes + u + 1],
+                    cell[(v + 1) * FineNodes + u + 1], cell[(v + 1) * FineNodes + u]
+                };
+
+                TraceCell(tile.Segments, limits, i0 + u, j0 + v, fineStep, corners);
+            }
+        }
+    }
+
+    // a sign change across a pole, like tan(x) = y at pi / 2, is no root: F at the interpolated crossing stays larger
+    // than at the nearer end of its edge, where at a real root it is close to zero
+    const std::size_t count = tile.Segments.size();
+
+    xs.resize(count * 2u);
+    ys.resize(count * 2u);
+    values.resize(count * 2u);
+
+    for (std::size_t s = 0u; s < count; ++s) {
+        xs[s * 2u] = tile.Segments[s].A.X;
+        ys[s * 2u] = tile.Segments[s].A.Y;
+        xs[s * 2u + 1u] = tile.Segments[s].B.X;
+        ys[s * 2u + 1u] = tile.Segments[s].B.Y;
+    }
+
+    field(xs.data(), ys.data(), values.data(), count * 2u);
+
+    std::size_t kept = 0u;
+
+    for (std::size_t s = 0u; s < count; ++s) {
+        const bool poleA = std::fabs(values[s * 2u]) > limits[s * 2u];
+        const bool poleB = std::fabs(values[s * 2u + 1u]) > limits[s * 2u + 1u];
+
+        // both ends, a root close to a corner can fail the test on one of them
+        if (!poleA || !poleB) {
+            tile.Segments[kept++] = tile.Segments[s];
+        }
+    }
+
+    tile.Segments.resize(kept);
+
+    return tile;
+}
+
+std::vector<Math::Contour::Point> Math::Contour::ChainSegments(const std::vector<const Tile*>& tiles) {
+    constexpr uint32_t None = std::numeric_limits<uint32_t>::max();
+    constexpr double Break = std::numeric_limits<double>::quiet_NaN();
+
+    std::vector<const Segment*> segments;
+
+    for (const Tile* tile : tiles) {
+        for (const Segment& segment : tile->Segments) {
+            segments.push_back(&segment);
+        }
+    }
+
+    // an edge is shared by at most the two cells next to it
+    std::unordered_map<EdgeKey, std::pair<uint32_t, uint32_t>, EdgeKeyHash> ends;
+    ends.reserve(segments.size() * 2u);
+
+    for (uint32_t s = 0u; s < segments.size(); ++s) {
+        for (const EdgeKey& key : {segments[s]->KeyA, segments[s]->KeyB}) {
+            auto [it, inserted] = ends.try_emplace(key, s, None);
+
+            if (!inserted && it->second.first != s) {
+                it->second.second = s;
+            }
+        }
+    }
+
+    std::vector<bool> used(segments.size(), false);
+    std::vector<Point> points;
+    std::deque<Point> line;
+
+    // follows the chain from `key`, leaving segment `from`
+    const auto walk = [&](EdgeKey key, uint32_t from, bool forward) {
+        while (true) {
+            const auto& [first, second] = ends.at(key);
+            const uint32_t next = first == from ? second : first;
+
+            if (next == None || used[next]) {
+                return;
+            }
+
+            used[next] = true;
+
+            const Segment& segment = *segments[next];
+            const bool fromA = segment.KeyA == key;
+
+            const Point p = fromA ? segment.B : segment.A;
+            forward ? line.push_back(p) : line.push_front(p);
+
+            key = fromA ? segment.KeyB : segment.KeyA;
+            from = next;
+        }
+    };
+
+    for (uint32_t s = 0u; s < segments.size(); ++s) {
+        if (used[s]) {
+            continue;
+        }
+
+        used[s] = true;
+
+        line.clear();
+        line.push_back(segments[s]->A);
+        line.push_back(segments[s]->B);
+
+        walk(segments[s]->KeyB, s, true);
+        walk(segments[s]->KeyA, s, false);
+
+        if (!points.empty()) {
+            points.push_back({Break, Break});
+        }
+
+        points.insert(points.end(), line.begin(), line.end());
+    }
+
+    return points;
+}
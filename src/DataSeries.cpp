@@ -0,0 +1,524 @@
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "App/DataSeries.hpp"
+
+#include "System/Profiler.hpp"
+#include "System/ThreadPool.hpp"
+
+constexpr std::size_t NoPoint = std::numeric_limits<std::size_t>::max();
+
+inline bool IsSet(const std::atomic<bool>* flag) {
+    return flag && flag->load(std::memory_order_relaxed);
+}
+
+#pragma region Parsing
+
+// bytes of CSV parsed by one task, rows are never split between tasks
+constexpr std::size_t ParseChunkSize = 1u << 20;
+
+inline bool IsBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+unsigned int DataSeries::ParseRow(const char* begin, const char* end, double* out, unsigned int count) {
+    unsigned int parsed = 0u;
+
+    while (parsed < count) {
+        while (begin < end && IsBlank(*begin)) {
+            ++begin;
+        }
+
+        // from_chars takes no plus sign
+        if (begin < end && *begin == '+') {
+            ++begin;
+        }
+
+        const auto [next, error] = std::from_chars(begin, end, out[parsed]);
+
+        if (error != std::errc()) {
+            break;
+        }
+
+        ++parsed;
+        begin = next;
+
+        while (begin < end && IsBlank(*begin)) {
+            ++begin;
+        }
+
+        if (begin < end && (*begin == ',' || *begin == ';')) {
+            ++begin;
+        }
+    }
+
+    return parsed;
+}
+
+// calls row(begin, end) for every line of [begin, end), without the line break, until it returns false
+template <typename F>
+void ForEachLine(const char* begin, const char* end, F&& row) {
+    while (begin < end) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(begin, '\n', static_cast<std::size_t>(end - begin)));
+
+        if (!lineEnd) {
+            lineEnd = end;
+        }
+
+        if (!row(begin, lineEnd)) {
+            return;
+        }
+
+        begin = lineEnd + 1;
+    }
+}
+
+#pragma region Loading
+
+System::Error::ResultWrapper<DataSeries> DataSeries::Load(const std::string& path, const std::atomic<bool>* cancelled) {
+    PROFILE_SCOPE("DataSeries::Load");
+
+    auto mapped = System::MappedFile::Open(path);
+
+    if (!mapped) {
+        return System::Error::failure<DataSeries>(mapped.error());
+    }
+
+    DataSeries series;
+    series.m_File = std::move(mapped).value();
+
+    const std::size_t size = series.m_File.GetSize();
+
+    const bool raw = path.ends_with(".f64") || path.ends_with(".bin");
+
+    if (raw) {
+        if (size % (2u * sizeof(double))) {
+            return System::Error::failure<DataSeries>(path + " doesn't hold whole (x, y) float64 pairs");
+        }
+
+        series.m_Count = size / (2u * sizeof(double));
+    } else {
+        const char* data = reinterpret_cast<const char*>(series.m_File.GetData());
+
+        // the first row with a number decides whether rows are (x, y) or y alone
+        unsigned int columns = 0u;
+
+        ForEachLine(data, data + size, [&columns](const char* begin, const char* end) {
+            double values[2];
+            columns = ParseRow(begin, end, values, 2u);
+
+            return !columns;
+        });
+
+        if (!columns) {
+            return System::Error::failure<DataSeries>(path + " holds no numbers");
+        }
+
+        // chunks start right after a line break
+        std::vector<std::size_t> bounds{0u};
+
+        for (std::size_t position = ParseChunkSize; position < size;) {
+            const void* lineEnd = std::memchr(data + position, '\n', size - position);
+
+            if (!lineEnd) {
+                break;
+            }
+
+            position = static_cast<std::size_t>(static_cast<const char*>(lineEnd) - data) + 1u;
+            bounds.push_back(position);
+            position += ParseChunkSize;
+        }
+
+        bounds.push_back(size);
+
+        std::vector<std::vector<double>> chunks(bounds.size() - 1u);
+
+        System::ThreadPool::Shared().ParallelFor(chunks.size(), 1u, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t c = begin; c < end && !IsSet(cancelled); ++c) {
+                std::vector<double>& values = chunks[c];
+
+                ForEachLine(data + bounds[c], data + bounds[c + 1u], [&values, columns](const char* begin, const char* end) {
+                    double row[2];
+
+                    if (ParseRow(begin, end, row, columns) != columns || (columns == 2u && !std::isfinite(row[0]))) {
+                        return true;
+                    }
+
+                    values.insert(values.end(), row, row + columns);
+                    return true;
+                });
+            }
+        });
+
+        if (IsSet(cancelled)) {
+            return System::Error::failure<DataSeries>("Loading " + path + " was cancelled");
+        }
+
+        // rows before each chunk, then the chunks copied in place with x filled in for single column files
+        std::vector<std::size_t> offsets(chunks.size() + 1u, 0u);
+
+        for (std::size_t c = 0u; c < chunks.size(); ++c) {
+            offsets[c + 1u] = offsets[c] + chunks[c].size() / columns;
+        }
+
+        series.m_Count = offsets.back();
+        series.m_Parsed.resize(2u * series.m_Count);
+
+        System::ThreadPool::Shared().ParallelFor(chunks.size(), 1u, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t c = begin; c < end; ++c) {
+                double* out = series.m_Parsed.data() + 2u * offsets[c];
+
+                if (columns == 2u) {
+                    std::copy(chunks[c].begin(), chunks[c].end(), out);
+                    continue;
+                }
+
+                for (std::size_t i = 0u; i < chunks[c].size(); ++i) {
+                    out[2u * i] = static_cast<double>(offsets[c] + i);
+                    out[2u * i + 1u] = chunks[c][i];
+                }
+            }
+        });
+
+        // the text is no longer needed
+        series.m_File = System::MappedFile();
+    }
+
+    if (!series.m_Count) {
+        return System::Error::failure<DataSeries>(path + " holds no data points");
+    }
+
+    series.m_Values = raw ? reinterpret_cast<const double*>(series.m_File.GetData()) : series.m_Parsed.data();
+
+    if (auto error = series.summarise(path, cancelled)) {
+        return System::Error::failure<DataSeries>(error.value());
+    }
+
+    return System::Error::success(std::move(series));
+}
+
+DataSeries::Extremes DataSeries::scanPoints(std::size_t begin, std::size_t end) const {
+    Extremes extremes{NoPoint, NoPoint};
+
+    // every finite value is below the first and above the second
+    double low = std::numeric_limits<double>::infinity();
+    double high = -low;
+
+    for (std::size_t i = begin; i < end; ++i) {
+        const double value = y(i);
+
+        if (!std::isfinite(value)) {
+            continue;
+        }
+
+        if (value < low) {
+            low = value;
+            extremes.Min = i;
+        }
+
+        if (value > high) {
+            high = value;
+            extremes.Max = i;
+        }
+    }
+
+    return extremes;
+}
+
+void DataSeries::merge(Extremes& extremes, const Extremes& other) const {
+    if (other.Min == NoPoint) {
+        return;
+    }
+
+    if (extremes.Min == NoPoint || y(other.Min) < y(extremes.Min)) {
+        extremes.Min = other.Min;
+    }
+
+    if (extremes.Max == NoPoint || y(other.Max) > y(extremes.Max)) {
+        extremes.Max = other.Max;
+    }
+}
+
+std::optional<std::string> DataSeries::summarise(const std::string& path, const std::atomic<bool>* cancelled) {
+    m_Blocks.assign((m_Count + BlockSize - 1u) / BlockSize, {NoPoint, NoPoint});
+
+    std::atomic<bool> ordered{true};
+
+    System::ThreadPool::Shared().ParallelFor(m_Blocks.size(), 16u, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t b = begin; b < end && !IsSet(cancelled); ++b) {
+            const std::size_t first = b * BlockSize;
+            const std::size_t last = std::min(first + BlockSize, m_Count);
+
+            for (std::size_t i = first; i < last; ++i) {
+                // the comparison is false for NaN
+                if (!(std::isfinite(x(i)) && (i == 0u || x(i) >= x(i - 1u)))) {
+                    ordered.store(false, std::memory_order_relaxed);
+                }
+            }
+
+            m_Blocks[b] = scanPoints(first, last);
+        }
+    });
+
+    if (IsSet(cancelled)) {
+        return "Loading " + path + " was cancelled";
+    }
+
+    if (!ordered.load()) {
+        return path + " must have finite x values in increasing order";
+    }
+
+    return std::nullopt;
+}
+
+#pragma region Decimation
+
+std::size_t DataSeries::lowerBound(double value) const {
+    std::size_t first = 0u;
+    std::size_t count = m_Count;
+
+    while (count) {
+        const std::size_t half = count / 2u;
+
+        if (x(first + half) < value) {
+            first += half + 1u;
+            count -= half + 1u;
+        } else {
+            count = half;
+        }
+    }
+
+    return first;
+}
+
+std::size_t DataSeries::upperBound(double value) const {
+    std::size_t first = 0u;
+    std::size_t count = m_Count;
+
+    while (count) {
+        const std::size_t half = count / 2u;
+
+        if (!(value < x(first + half))) {
+            first += half + 1u;
+            count -= half + 1u;
+        } else {
+            count = half;
+        }
+    }
+
+    return first;
+}
+
+DataSeries::Extremes DataSeries::scan(std::size_t begin, std::size_t end) const {
+    const std::size_t firstBlock = (begin + BlockSize - 1u) / BlockSize;
+    const std::size_t lastBlock = end / BlockSize;
+
+    if (firstBlock >= lastBlock) {
+        return scanPoints(begin, end);
+    }
+
+    Extremes extremes = scanPoints(begin, firstBlock * BlockSize);
+
+    for (std::size_t b = firstBlock; b < lastBlock; ++b) {
+        merge(extremes, m_Blocks[b]);
+    }
+
+    merge(extremes, scanPoints(lastBlock * BlockSize, end));
+
+    return extremes;
+}
+
+std::vector<sf::Vector2f> DataSeries::Decimate(
+    double left, double right, unsigned int columns, Decimation method, double origin, const std::atomic<bool>* cancelled
+) const {
+    PROFILE_SCOPE("DataSeries::Decimate");
+
+    if (!m_Count || !columns || !(left < right)) {
+        return {};
+    }
+
+    const std::size_t first = lowerBound(left);
+    const std::size_t last = upperBound(right);
+
+    const std::size_t begin = first ? first - 1u : 0u;
+    const std::size_t end = std::min(last + 1u, m_Count);
+
+    if (end - begin <= 2u * static_cast<std::size_t>(columns)) {
+        std::vector<sf::Vector2f> points;
+        points.reserve(end - begin);
+
+        for (std::size_t i = begin; i < end; ++i) {
+            points.push_back(point(i, origin));
+        }
+
+        return points;
+    }
+
+    // column c holds the points in [bounds[c], bounds[c + 1])
+    std::vector<std::size_t> bounds(columns + 1u);
+    const double width = (right - left) / columns;
+
+    bounds.front() = first;
+    bounds.back() = last;
+
+    for (unsigned int c = 1u; c < columns; ++c) {
+        bounds[c] = lowerBound(left + c * width);
+    }
+
+    if (method == Decimation::Lttb) {
+        return lttb(bounds, begin, end, origin, cancelled);
+    }
+
+    return minMax(bounds, begin, end, origin, cancelled);
+}
+
+std::vector<sf::Vector2f> DataSeries::minMax(
+    const std::vector<std::size_t>& bounds, std::size_t begin, std::size_t end, double origin, const std::atomic<bool>* cancelled
+) const {
+    const std::size_t columns = bounds.size() - 1u;
+
+    std::vector<std::size_t> picked(2u * columns, NoPoint);
+
+    System::ThreadPool::Shared().ParallelFor(columns, 64u, [&](std::size_t first, std::size_t last) {
+        for (std::size_t c = first; c < last && !IsSet(cancelled); ++c) {
+            if (bounds[c] == bounds[c + 1u]) {
+                continue;
+            }
+
+            const Extremes extremes = scan(bounds[c], bounds[c + 1u]);
+
+            // nothing finite, one of its points breaks the line
+            if (extremes.Min == NoPoint) {
+                picked[2u * c] = bounds[c];
+                continue;
+            }
+
+            // in the order they were measured
+            picked[2u * c] = std::min(extremes.Min, extremes.Max);
+
+            if (extremes.Min != extremes.Max) {
+                picked[2u * c + 1u] = std::max(extremes.Min, extremes.Max);
+            }
+        }
+    });
+
+    if (IsSet(cancelled)) {
+        return {};
+    }
+
+    std::vector<sf::Vector2f> points;
+    points.reserve(picked.size() + 2u);
+
+    if (begin < bounds.front()) {
+        points.push_back(point(begin, origin));
+    }
+
+    for (std::size_t i : picked) {
+        if (i != NoPoint) {
+            points.push_back(point(i, origin));
+        }
+    }
+
+    if (end > bounds.back()) {
+        points.push_back(point(end - 1u, origin));
+    }
+
+    return points;
+}
+
+std::vector<sf::Vector2f> DataSeries::lttb(
+    const std::vector<std::size_t>& bounds, std::size_t begin, std::size_t end, double origin, const std::atomic<bool>* cancelled
+) const {
+    const std::size_t columns = bounds.size() - 1u;
+
+    struct Average {
+        double X;
+        double Y;
+        bool Valid;
+    };
+
+    // centroid of each column's finite points, the far corner of the triangles of the column before it
+    std::vector<Average> averages(columns, {0.0, 0.0, false});
+
+    System::ThreadPool::Shared().ParallelFor(columns, 64u, [&](std::size_t first, std::size_t last) {
+        for (std::size_t c = first; c < last && !IsSet(cancelled); ++c) {
+            double sumX = 0.0;
+            double sumY = 0.0;
+            std::size_t count = 0u;
+
+            for (std::size_t i = bounds[c]; i < bounds[c + 1u]; ++i) {
+                if (std::isfinite(y(i))) {
+                    sumX += x(i);
+                    sumY += y(i);
+                    ++count;
+                }
+            }
+
+            if (count) {
+                averages[c] = {sumX / count, sumY / count, true};
+            }
+        }
+    });
+
+    // the first and the last point are always kept, every column picks the point that spans the largest triangle
+    // with the previous pick and the centroid of the next column that has one
+    std::vector<sf::Vector2f> points;
+    points.reserve(columns + 2u);
+    points.push_back(point(begin, origin));
+
+    std::size_t anchor = begin;
+    std::size_t next = 0u;
+
+    for (std::size_t c = 0u; c < columns; ++c) {
+        if (IsSet(cancelled)) {
+            return {};
+        }
+
+        const std::size_t first = std::max(bounds[c], begin + 1u);
+        const std::size_t last = std::min(bounds[c + 1u], end - 1u);
+
+        if (first >= last) {
+            continue;
+        }
+
+        next = std::max(next, c + 1u);
+
+        while (next < columns && !averages[next].Valid) {
+            ++next;
+        }
+
+        const double cx = next < columns ? averages[next].X : x(end - 1u);
+        const double cy = next < columns ? averages[next].Y : y(end - 1u);
+
+        const double ax = x(anchor);
+        const double ay = y(anchor);
+
+        std::size_t best = NoPoint;
+        double bestArea = -1.0;
+
+        for (std::size_t i = first; i < last; ++i) {
+            const double area = std::abs((ax - cx) * (y(i) - ay) - (ax - x(i)) * (cy - ay));
+
+            // false for NaN, so a column of nothing but gaps keeps its first point and breaks the line
+            if (area > bestArea) {
+                bestArea = area;
+                best = i;
+            }
+        }
+
+        if (best == NoPoint) {
+            best = first;
+        }
+
+        points.push_back(point(best, origin));
+        anchor = best;
+    }
+
+    points.push_back(point(end - 1u, origin));
+
+    return points;
+}
@@ -2,6 +2,8 @@
 
 #include "App/Equation.hpp"
 
+#include "System/Profiler.hpp"
+
 #include "Vendor/tinyexpr.h"
 
 void TrimInPlace(std::string& s) {
@@ -151,6 +153,8 @@ std::pair<std::string, std::pair<double, double>> SplitExpressionsAndDomain(cons
 }
 
 System::Error::ResultWrapper<Equation> Equation::Parse(const std::string& raw) {
+    PROFILE_SCOPE("Equation::Parse");
+
     Equation eq;
 
     if (raw.empty()) {
@@ -169,7 +173,39 @@ System::Error::ResultWrapper<Equation> Equation::Parse(const std::string& raw) {
     eq.DomainLeft = domain.first;
     eq.DomainRight = domain.second;
 
-    /* ---------- 2. Parametric detection ---------- */
+    /* ---------- 2. Implicit detection ---------- */
+
+    if (const std::size_t equalsPos = expr.find('='); equalsPos != std::string::npos) {
+        if (expr.find('=', equalsPos + 1) != std::string::npos) {
+            return System::Error::failure<Equation>("Implicit equation has more than one '='");
+        }
+
+        std::string lhs = expr.substr(0, equalsPos);
+        std::string rhs = expr.substr(equalsPos + 1);
+
+        TrimInPlace(lhs);
+        TrimInPlace(rhs);
+
+        if (lhs.empty() || rhs.empty()) {
+            return System::Error::failure<Equation>("Implicit equation needs an expression on both sides of '='");
+        }
+
+        // z = f(x, y) → a scalar field coloured over the plane
+        if (lhs == "z") {
+            eq.Type = EquationType::ScalarField;
+            eq.Expression_1 = rhs;
+
+            return System::Error::success(eq);
+        }
+
+        // f(x, y) = g(x, y) → f(x, y) - g(x, y) = 0, the domain does not apply
+        eq.Type = EquationType::Implicit;
+        eq.Expression_1 = "(" + lhs + ") - (" + rhs + ")";
+
+        return System::Error::success(eq);
+    }
+
+    /* ---------- 3. Parametric detection ---------- */
 
     if (expr.find(',') != std::string::npos) {
         StripOuterParentheses(expr);
@@ -198,7 +234,7 @@ System::Error::ResultWrapper<Equation> Equation::Parse(const std::string& raw) {
         return System::Error::success(eq);
     }
 
-    /* ---------- 3. Explicit detection ---------- */
+    /* ---------- 4. Explicit detection ---------- */
 
     const bool usesY = UsesStandaloneSymbol(expr, 'y');
 
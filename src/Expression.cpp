@@ -0,0 +1,786 @@
+#include <cmath>
+#include <cctype>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+
+#include "Math/Expression.hpp"
+#include "Math/Simd.hpp"
+#include "Math/Jit.hpp"
+
+#pragma region Operations
+
+double Factorial(double a) {
+    if (a < 0.0) {
+        return NAN;
+    }
+
+    if (a > UINT_MAX) {
+        return INFINITY;
+    }
+
+    const unsigned int ua = static_cast<unsigned int>(a);
+    unsigned long long result = 1u;
+
+    for (unsigned long long i = 1u; i <= ua; ++i) {
+        if (i > ULLONG_MAX / result) {
+            return INFINITY;
+        }
+
+        result *= i;
+    }
+
+    return static_cast<double>(result);
+}
+
+double Combinations(double n, double r) {
+    if (n < 0.0 || r < 0.0 || n < r) {
+        return NAN;
+    }
+
+    if (n > UINT_MAX || r > UINT_MAX) {
+        return INFINITY;
+    }
+
+    const unsigned long long un = static_cast<unsigned int>(n);
+    unsigned long long ur = static_cast<unsigned int>(r);
+
+    if (ur > un / 2u) {
+        ur = un - ur;
+    }
+
+    unsigned long long result = 1u;
+
+    for (unsigned long long i = 1u; i <= ur; ++i) {
+        if (result > ULLONG_MAX / (un - ur + i)) {
+            return INFINITY;
+        }
+
+        result *= un - ur + i;
+        result /= i;
+    }
+
+    return static_cast<double>(result);
+}
+
+inline double ApplyOperation(Math::OpCode op, double a, double b) {
+    using Math::OpCode;
+
+    switch (op) {
+        case OpCode::Add: return a + b;
+        case OpCode::Sub: return a - b;
+        case OpCode::Mul: return a * b;
+        case OpCode::Div: return a / b;
+        case OpCode::Mod: return std::fmod(a, b);
+        case OpCode::Pow: return std::pow(a, b);
+        case OpCode::Atan2: return std::atan2(a, b);
+        case OpCode::Ncr: return Combinations(a, b);
+        case OpCode::Npr: return Combinations(a, b) * Factorial(b);
+        case OpCode::Neg: return -a;
+        case OpCode::Abs: return std::fabs(a);
+        case OpCode::Acos: return std::acos(a);
+        case OpCode::Asin: return std::asin(a);
+        case OpCode::Atan: return std::atan(a);
+        case OpCode::Ceil: return std::ceil(a);
+        case OpCode::Cos: return std::cos(a);
+        case OpCode::Cosh: return std::cosh(a);
+        case OpCode::Exp: return std::exp(a);
+        case OpCode::Fac: return Factorial(a);
+        case OpCode::Floor: return std::floor(a);
+        case OpCode::Ln: return std::log(a);
+        case OpCode::Log10: return std::log10(a);
+        case OpCode::Sin: return std::sin(a);
+        case OpCode::Sinh: return std::sinh(a);
+        case OpCode::Sqrt: return std::sqrt(a);
+        case OpCode::Tan: return std::tan(a);
+        case OpCode::Tanh: return std::tanh(a);
+    }
+
+    return NAN;
+}
+
+double Math::Apply(OpCode op, double a, double b) {
+    return ApplyOperation(op, a, b);
+}
+
+#pragma region Parsing
+
+struct Builtin {
+    const char* Name;
+    int Arity; // 0 = constant
+    Math::OpCode Op;
+    double Value;
+};
+
+constexpr Builtin Builtins[] = {
+    {"abs", 1, Math::OpCode::Abs, 0.0},
+    {"acos", 1, Math::OpCode::Acos, 0.0},
+    {"asin", 1, Math::OpCode::Asin, 0.0},
+    {"atan", 1, Math::OpCode::Atan, 0.0},
+    {"atan2", 2, Math::OpCode::Atan2, 0.0},
+    {"ceil", 1, Math::OpCode::Ceil, 0.0},
+    {"cos", 1, Math::OpCode::Cos, 0.0},
+    {"cosh", 1, Math::OpCode::Cosh, 0.0},
+    {"e", 0, Math::OpCode::Add, 2.71828182845904523536},
+    {"exp", 1, Math::OpCode::Exp, 0.0},
+    {"fac", 1, Math::OpCode::Fac, 0.0},
+    {"floor", 1, Math::OpCode::Floor, 0.0},
+    {"ln", 1, Math::OpCode::Ln, 0.0},
+    {"log", 1, Math::OpCode::Log10, 0.0},
+    {"log10", 1, Math::OpCode::Log10, 0.0},
+    {"ncr", 2, Math::OpCode::Ncr, 0.0},
+    {"npr", 2, Math::OpCode::Npr, 0.0},
+    {"pi", 0, Math::OpCode::Add, 3.14159265358979323846},
+    {"pow", 2, Math::OpCode::Pow, 0.0},
+    {"sin", 1, Math::OpCode::Sin, 0.0},
+    {"sinh", 1, Math::OpCode::Sinh, 0.0},
+    {"sqrt", 1, Math::OpCode::Sqrt, 0.0},
+    {"tan", 1, Math::OpCode::Tan, 0.0},
+    {"tanh", 1, Math::OpCode::Tanh, 0.0},
+};
+
+struct ExpressionNode {
+    enum class Kind : uint8_t {
+        Constant,
+        Variable,
+        Operation
+    };
+
+    Kind Type;
+    Math::OpCode Op;
+    uint16_t Variable;
+    double Value;
+    uint32_t A;
+    uint32_t B;
+
+    // constants compare by bit pattern, so 0.0 and -0.0 stay apart
+    bool operator==(const ExpressionNode& other) const noexcept {
+        return Type == other.Type && Op == other.Op && Variable == other.Variable && A == other.A && B == other.B &&
+            std::memcmp(&Value, &other.Value, sizeof(double)) == 0;
+    }
+};
+
+struct ExpressionNodeHash {
+    std::size_t operator()(const ExpressionNode& node) const noexcept {
+        uint64_t bits;
+        std::memcpy(&bits, &node.Value, sizeof(double));
+
+        uint64_t h = static_cast<uint64_t>(node.Type) | static_cast<uint64_t>(node.Op) << 8u | static_cast<uint64_t>(node.Variable) << 16u;
+        h = (h ^ bits) * 0x9E3779B97F4A7C15ull;
+        h = (h ^ node.A) * 0xC2B2AE3D27D4EB4Full;
+        h = (h ^ node.B) * 0x165667B19E3779F9ull;
+
+        return static_cast<std::size_t>(h ^ (h >> 32u));
+    }
+};
+
+constexpr uint32_t InvalidNode = UINT32_MAX;
+
+// hash-consed nodes of every source compiled together, structurally equal subexpressions are built once
+class ExpressionDag {
+private:
+    uint32_t intern(const ExpressionNode& node) {
+        const auto [it, inserted] = m_Lookup.try_emplace(node, static_cast<uint32_t>(Nodes.size()));
+
+        if (inserted) {
+            Nodes.push_back(node);
+        }
+
+        return it->second;
+    }
+
+    // by bit pattern, so -0 is not 0
+    [[nodiscard]] bool isConstant(uint32_t index, double value) const {
+        return Nodes[index].Type == ExpressionNode::Kind::Constant && std::memcmp(&Nodes[index].Value, &value, sizeof(double)) == 0;
+    }
+
+    [[nodiscard]] bool isOperation(uint32_t index, Math::OpCode op) const {
+        return Nodes[index].Type == ExpressionNode::Kind::Operation && Nodes[index].Op == op;
+    }
+
+    // rewrites only where the result is exactly the same double, signed zeros included,
+    // so nothing like x * 0, x - x or x + 0
+    uint32_t operation(Math::OpCode op, uint32_t a, uint32_t b) {
+        using Math::OpCode;
+
+        // constant folding, subtrees are folded bottom up as they are built
+        const bool foldable = Nodes[a].Type == ExpressionNode::Kind::Constant && (!Math::IsBinary(op) || Nodes[b].Type == ExpressionNode::Kind::Constant);
+
+        if (foldable) {
+            return constant(ApplyOperation(op, Nodes[a].Value, Math::IsBinary(op) ? Nodes[b].Value : 0.0));
+        }
+
+        switch (op) {
+            case OpCode::Add:
+                if (isOperation(b, OpCode::Neg)) return operation(OpCode::Sub, a, Nodes[b].A);
+                if (isOperation(a, OpCode::Neg)) return operation(OpCode::Sub, b, Nodes[a].A);
+                break;
+            case OpCode::Sub:
+                if (isConstant(b, 0.0)) return a;
+                if (isOperation(b, OpCode::Neg)) return operation(OpCode::Add, a, Nodes[b].A);
+                break;
+            case OpCode::Mul:
+                if (isConstant(b, 1.0)) return a;
+                if (isConstant(a, 1.0)) return b;
+                if (isConstant(b, -1.0)) return operation(OpCode::Neg, a, InvalidNode);
+                if (isConstant(a, -1.0)) return operation(OpCode::Neg, b, InvalidNode);
+                if (isOperation(a, OpCode::Neg) && isOperation(b, OpCode::Neg)) return operation(OpCode::Mul, Nodes[a].A, Nodes[b].A);
+                break;
+            case OpCode::Div:
+                if (isConstant(b, 1.0)) return a;
+                if (isOperation(a, OpCode::Neg) && isOperation(b, OpCode::Neg)) return operation(OpCode::Div, Nodes[a].A, Nodes[b].A);
+                break;
+            case OpCode::Pow:
+                if (isConstant(b, 1.0)) return a;
+                break;
+            case OpCode::Neg:
+                if (isOperation(a, OpCode::Neg)) return Nodes[a].A;
+                break;
+            default:
+                break;
+        }
+
+        // a canonical operand order lets a + b and b + a share one node
+        if ((op == OpCode::Add || op == OpCode::Mul) && a > b) {
+            std::swap(a, b);
+        }
+
+        return intern({ExpressionNode::Kind::Operation, op, 0u, 0.0, a, Math::IsBinary(op) ? b : InvalidNode});
+    }
+
+    uint32_t constant(double value) {
+        return intern({ExpressionNode::Kind::Constant, Math::OpCode::Add, 0u, value, InvalidNode, InvalidNode});
+    }
+
+    std::unordered_map<ExpressionNode, uint32_t, ExpressionNodeHash> m_Lookup;
+
+public:
+    // the builders below are called once per node of the source, rewrites go through the private ones
+    uint32_t MakeConstant(double value) {
+        ++TreeNodes;
+        return constant(value);
+    }
+
+    uint32_t MakeVariable(uint16_t variable) {
+        ++TreeNodes;
+        return intern({ExpressionNode::Kind::Variable, Math::OpCode::Add, variable, 0.0, InvalidNode, InvalidNode});
+    }
+
+    uint32_t MakeOperation(Math::OpCode op, uint32_t a, uint32_t b = InvalidNode) {
+        if (a == InvalidNode || (Math::IsBinary(op) && b == InvalidNode)) {
+            return InvalidNode;
+        }
+
+        ++TreeNodes;
+        return operation(op, a, b);
+    }
+
+    std::vector<ExpressionNode> Nodes;
+    std::size_t TreeNodes{0u};
+};
+
+class ExpressionParser {
+private:
+    enum class Token : uint8_t {
+        End,
+        Number,
+        Identifier,
+        Operator,
+        Open,
+        Close,
+        Comma,
+        Error
+    };
+
+    void next() {
+        while (m_Cursor < m_Source.size() && std::isspace(static_cast<unsigned char>(m_Source[m_Cursor]))) {
+            ++m_Cursor;
+        }
+
+        m_TokenStart = m_Cursor;
+
+        if (m_Cursor >= m_Source.size()) {
+            m_Token = Token::End;
+            return;
+        }
+
+        const char c = m_Source[m_Cursor];
+
+        if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+            char* end = nullptr;
+            m_Number = std::strtod(m_Source.c_str() + m_Cursor, &end);
+            m_Cursor = static_cast<std::size_t>(end - m_Source.c_str());
+            m_Token = Token::Number;
+        } else if (std::isalpha(static_cast<unsigned char>(c))) {
+            while (
+                m_Cursor < m_Source.size() &&
+                (std::isalnum(static_cast<unsigned char>(m_Source[m_Cursor])) || m_Source[m_Cursor] == '_')
+            ) {
+                ++m_Cursor;
+            }
+
+            m_Identifier = std::string_view(m_Source).substr(m_TokenStart, m_Cursor - m_TokenStart);
+            m_Token = Token::Identifier;
+        } else {
+            ++m_Cursor;
+            m_Operator = c;
+
+            switch (c) {
+                case '+': case '-': case '*': case '/': case '^': case '%':
+                    m_Token = Token::Operator;
+                    break;
+                case '(':
+                    m_Token = Token::Open;
+                    break;
+                case ')':
+                    m_Token = Token::Close;
+                    break;
+                case ',':
+                    m_Token = Token::Comma;
+                    break;
+                default:
+                    m_Token = Token::Error;
+                    break;
+            }
+        }
+    }
+
+    uint32_t fail() {
+        if (!ErrorPosition) {
+            ErrorPosition = m_Cursor ? m_Cursor : 1u;
+        }
+
+        return InvalidNode;
+    }
+
+    // <base> = <constant> | <variable> | <function-0> {"(" ")"} | <function-1> <power> | <function-X> "(" <expr> {"," <expr>} ")" | "(" <list> ")"
+    uint32_t parseBase() {
+        if (m_Token == Token::Number) {
+            const double value = m_Number;
+            next();
+            return m_Dag.MakeConstant(value);
+        }
+
+        if (m_Token == Token::Open) {
+            next();
+            const uint32_t inner = parseList();
+
+            if (m_Token != Token::Close) {
+                return fail();
+            }
+
+            next();
+            return inner;
+        }
+
+        if (m_Token != Token::Identifier) {
+            return fail();
+        }
+
+        for (std::size_t i = 0u; i < m_Variables.size(); ++i) {
+            if (m_Identifier == m_Variables[i]) {
+                next();
+                return m_Dag.MakeVariable(static_cast<uint16_t>(i));
+            }
+        }
+
+        const Builtin* builtin = nullptr;
+
+        for (const Builtin& candidate : Builtins) {
+            if (m_Identifier == candidate.Name) {
+                builtin = &candidate;
+                break;
+            }
+        }
+
+        if (!builtin) {
+            return fail();
+        }
+
+        next();
+
+        if (builtin->Arity == 0) {
+            if (m_Token == Token::Open) {
+                next();
+
+                if (m_Token != Token::Close) {
+                    return fail();
+                }
+
+                next();
+            }
+
+            return m_Dag.MakeConstant(builtin->Value);
+        }
+
+        if (builtin->Arity == 1) {
+            return m_Dag.MakeOperation(builtin->Op, parsePower());
+        }
+
+        if (m_Token != Token::Open) {
+            return fail();
+        }
+
+        next();
+        const uint32_t a = parseExpr();
+
+        if (a == InvalidNode || m_Token != Token::Comma) {
+            return fail();
+        }
+
+        next();
+        const uint32_t b = parseExpr();
+
+        if (b == InvalidNode || m_Token != Token::Close) {
+            return fail();
+        }
+
+        next();
+        return m_Dag.MakeOperation(builtin->Op, a, b);
+    }
+
+    // <power> = {("-" | "+")} <base>
+    uint32_t parsePower() {
+        bool negate = false;
+
+        while (m_Token == Token::Operator && (m_Operator == '-' || m_Operator == '+')) {
+            negate ^= m_Operator == '-';
+            next();
+        }
+
+        const uint32_t base = parseBase();
+        return negate ? m_Dag.MakeOperation(Math::OpCode::Neg, base) : base;
+    }
+
+    // <factor> = <power> {"^" <power>}
+    uint32_t parseFactor() {
+        uint32_t result = parsePower();
+
+        while (result != InvalidNode && m_Token == Token::Operator && m_Operator == '^') {
+            next();
+            result = m_Dag.MakeOperation(Math::OpCode::Pow, result, parsePower());
+        }
+
+        return result;
+    }
+
+    // <term> = <factor> {("*" | "/" | "%") <factor>}
+    uint32_t parseTerm() {
+        uint32_t result = parseFactor();
+
+        while (result != InvalidNode && m_Token == Token::Operator && (m_Operator == '*' || m_Operator == '/' || m_Operator == '%')) {
+            const Math::OpCode op = m_Operator == '*' ? Math::OpCode::Mul : m_Operator == '/' ? Math::OpCode::Div : Math::OpCode::Mod;
+            next();
+            result = m_Dag.MakeOperation(op, result, parseFactor());
+        }
+
+        return result;
+    }
+
+    // <expr> = <term> {("+" | "-") <term>}
+    uint32_t parseExpr() {
+        uint32_t result = parseTerm();
+
+        while (result != InvalidNode && m_Token == Token::Operator && (m_Operator == '+' || m_Operator == '-')) {
+            const Math::OpCode op = m_Operator == '+' ? Math::OpCode::Add : Math::OpCode::Sub;
+            next();
+            result = m_Dag.MakeOperation(op, result, parseTerm());
+        }
+
+        return result;
+    }
+
+    // <list> = <expr> {"," <expr>}, evaluates to the last expression
+    uint32_t parseList() {
+        uint32_t result = parseExpr();
+
+        while (result != InvalidNode && m_Token == Token::Comma) {
+            next();
+            result = parseExpr();
+        }
+
+        return result;
+    }
+
+    const std::string& m_Source;
+    const std::vector<std::string>& m_Variables;
+    ExpressionDag& m_Dag;
+
+    std::size_t m_Cursor{0u};
+    std::size_t m_TokenStart{0u};
+
+    Token m_Token{Token::End};
+    double m_Number{0.0};
+    char m_Operator{0};
+    std::string_view m_Identifier;
+
+public:
+    ExpressionParser(const std::string& source, const std::vector<std::string>& variables, ExpressionDag& dag) : m_Source(source), m_Variables(variables), m_Dag(dag) {}
+
+    uint32_t Parse() {
+        next();
+
+        const uint32_t root = parseList();
+
+        if (root == InvalidNode) {
+            return root;
+        }
+
+        if (m_Token != Token::End) {
+            return fail();
+        }
+
+        return root;
+    }
+
+    std::size_t ErrorPosition{0u};
+};
+
+#pragma region Code Generation
+
+class ExpressionEmitter {
+private:
+    static constexpr uint16_t Unassigned = UINT16_MAX;
+
+    // counts one use per edge into the node, the first visit walks the operands and assigns inputs and constants
+    void visit(uint32_t index) {
+        if (m_Uses[index]++ != 0u) {
+            return;
+        }
+
+        ++Reachable;
+
+        const ExpressionNode& node = m_Nodes[index];
+
+        if (node.Type == ExpressionNode::Kind::Variable) {
+            m_Registers[index] = node.Variable;
+        } else if (node.Type == ExpressionNode::Kind::Constant) {
+            // constants are already unique in the DAG
+            m_Registers[index] = static_cast<uint16_t>(m_Variables + Constants.size());
+            Constants.push_back(node.Value);
+        } else {
+            visit(node.A);
+
+            if (Math::IsBinary(node.Op)) {
+                visit(node.B);
+            }
+        }
+    }
+
+    uint16_t allocate() {
+        if (!m_Free.empty()) {
+            const uint16_t r = m_Free.back();
+            m_Free.pop_back();
+            return r;
+        }
+
+        return static_cast<uint16_t>(m_FirstTemporary + TemporaryCount++);
+    }
+
+    // a shared node keeps its register until its last user has been emitted
+    void consume(uint32_t index) {
+        if (--m_Uses[index] == 0u && m_Registers[index] >= m_FirstTemporary) {
+            m_Free.push_back(m_Registers[index]);
+        }
+    }
+
+    const std::vector<ExpressionNode>& m_Nodes;
+    std::vector<uint16_t> m_Free;
+
+    std::vector<uint32_t> m_Uses;
+    std::vector<uint16_t> m_Registers;
+
+    std::size_t m_Variables;
+    std::size_t m_FirstTemporary{0u};
+
+public:
+    ExpressionEmitter(const std::vector<ExpressionNode>& nodes, std::size_t variables)
+        : m_Nodes(nodes), m_Uses(nodes.size(), 0u), m_Registers(nodes.size(), Unassigned), m_Variables(variables) {}
+
+    // the extra use every root gets is never consumed, so results stay in their registers
+    void Prepare(const std::vector<uint32_t>& roots) {
+        for (uint32_t root : roots) {
+            visit(root);
+        }
+
+        m_FirstTemporary = m_Variables + Constants.size();
+    }
+
+    // post-order walk, each node is emitted once and temporaries are recycled after their last use
+    uint16_t Emit(uint32_t index) {
+        if (m_Registers[index] != Unassigned) {
+            return m_Registers[index];
+        }
+
+        const ExpressionNode& node = m_Nodes[index];
+
+        const uint16_t a = Emit(node.A);
+        const uint16_t b = Math::IsBinary(node.Op) ? Emit(node.B) : 0u;
+
+        consume(node.A);
+
+        if (Math::IsBinary(node.Op)) {
+            consume(node.B);
+        }
+
+        const uint16_t dst = allocate();
+        Code.push_back({node.Op, dst, a, b});
+
+        m_Registers[index] = dst;
+        return dst;
+    }
+
+    std::vector<Math::Instruction> Code;
+    std::vector<double> Constants;
+    std::size_t TemporaryCount{0u};
+    std::size_t Reachable{0u};
+};
+
+System::Error::ResultWrapper<Math::Expression> Math::Expression::Compile(const std::string& source, const std::vector<std::string>& variables) {
+    return Compile(std::vector<std::string>{source}, variables);
+}
+
+System::Error::ResultWrapper<Math::Expression> Math::Expression::Compile(const std::vector<std::string>& sources, const std::vector<std::string>& variables) {
+    constexpr std::size_t MaxRegisters = UINT16_MAX;
+
+    ExpressionDag dag;
+    std::vector<uint32_t> roots;
+
+    for (std::size_t i = 0u; i < sources.size(); ++i) {
+        ExpressionParser parser(sources[i], variables, dag);
+        const uint32_t root = parser.Parse();
+
+        if (root == InvalidNode) {
+            const std::string where = sources.size() > 1u ? "error in expression " + std::to_string(i + 1u) + " at position: " : "error at position: ";
+            return System::Error::failure<Expression>(where + std::to_string(parser.ErrorPosition));
+        }
+
+        roots.push_back(root);
+    }
+
+    ExpressionEmitter emitter(dag.Nodes, variables.size());
+    emitter.Prepare(roots);
+
+    if (variables.size() + emitter.Constants.size() + emitter.Reachable >= MaxRegisters) {
+        return System::Error::failure<Expression>("expression is too large");
+    }
+
+    Expression expression;
+
+    for (uint32_t root : roots) {
+        expression.m_Results.push_back(emitter.Emit(root));
+    }
+
+    expression.m_Code = std::move(emitter.Code);
+    expression.m_Variables = static_cast<uint16_t>(variables.size());
+    expression.m_NodeCounts = {dag.TreeNodes, emitter.Reachable};
+
+    expression.m_Registers.assign(variables.size() + emitter.Constants.size() + emitter.TemporaryCount, 0.0);
+    std::copy(emitter.Constants.begin(), emitter.Constants.end(), expression.m_Registers.begin() + variables.size());
+
+    // the interpreter stays the fallback whenever no program could be generated
+    if (Jit::IsEnabled()) {
+        expression.m_Native = Jit::Compile(expression.m_Code, expression.m_Results, BatchSize, Simd::GetIsa());
+    }
+
+    return System::Error::success(std::move(expression));
+}
+
+#pragma region Evaluation
+
+Math::Expression::Context Math::Expression::CreateContext() const {
+    return Context{m_Registers, {}, {}};
+}
+
+double Math::Expression::Evaluate(Context& context, const double* inputs) const {
+    double* registers = context.Registers.data();
+
+    for (uint16_t i = 0u; i < m_Variables; ++i) {
+        registers[i] = inputs[i];
+    }
+
+    for (const Instruction& instruction : m_Code) {
+        registers[instruction.Dst] = ApplyOperation(instruction.Op, registers[instruction.A], registers[instruction.B]);
+    }
+
+    return registers[m_Results.front()];
+}
+
+void Math::Expression::Evaluate(Context& context, const double* inputs, double* outputs) const {
+    outputs[0] = Evaluate(context, inputs);
+
+    for (std::size_t i = 1u; i < m_Results.size(); ++i) {
+        outputs[i] = context.Registers[m_Results[i]];
+    }
+}
+
+void Math::Expression::evaluateBatch(Context& context, const double* const* inputs, double* const* outputs, std::size_t outputCount, std::size_t count) const {
+    const std::size_t registerCount = m_Registers.size();
+
+    if (context.BatchRegisters.size() != registerCount * BatchSize) {
+        context.BatchRegisters.assign(registerCount * BatchSize, 0.0);
+
+        // constant rows are broadcast once and never written again
+        for (std::size_t r = m_Variables; r < registerCount; ++r) {
+            std::fill_n(context.BatchRegisters.begin() + r * BatchSize, BatchSize, m_Registers[r]);
+        }
+    }
+
+    double* rows = context.BatchRegisters.data();
+    const Jit::Program* native = m_Native && Jit::IsEnabled() ? m_Native.get() : nullptr;
+
+    for (std::size_t offset = 0u; offset < count; offset += BatchSize) {
+        const std::size_t lanes = std::min(BatchSize, count - offset);
+        const std::size_t padded = (lanes + Simd::MaxWidth - 1u) / Simd::MaxWidth * Simd::MaxWidth;
+
+        for (uint16_t v = 0u; v < m_Variables; ++v) {
+            double* row = rows + v * BatchSize;
+
+            std::copy_n(inputs[v] + offset, lanes, row);
+            std::fill(row + lanes, row + padded, 0.0);
+        }
+
+        if (native) {
+            native->Run(rows, padded);
+        } else {
+            for (const Instruction& instruction : m_Code) {
+                Simd::GetKernel(instruction.Op)(
+                    rows + instruction.Dst * BatchSize,
+                    rows + instruction.A * BatchSize,
+                    rows + instruction.B * BatchSize,
+                    padded
+                );
+            }
+        }
+
+        for (std::size_t i = 0u; i < outputCount; ++i) {
+            std::copy_n(rows + m_Results[i] * BatchSize, lanes, outputs[i] + offset);
+        }
+    }
+}
+
+Math::IntervalValue Math::Expression::EvaluateInterval(Context& context, const Interval* inputs) const {
+    const std::size_t registerCount = m_Registers.size();
+
+    if (context.IntervalRegisters.size() != registerCount) {
+        context.IntervalRegisters.assign(registerCount, IntervalValue::Constant(0.0));
+
+        for (std::size_t r = m_Variables; r < registerCount; ++r) {
+            context.IntervalRegisters[r] = IntervalValue::Constant(m_Registers[r]);
+        }
+    }
+
+    IntervalValue* registers = context.IntervalRegisters.data();
+
+    for (uint16_t i = 0u; i < m_Variables; ++i) {
+        registers[i] = IntervalValue::Variable(inputs[i], i == 0u);
+    }
+
+    for (const Instruction& instruction : m_Code) {
+        registers[instruction.Dst] = Apply(instruction.Op, registers[instruction.A], registers[instruction.B]);
+    }
+
+    return registers[m_Results.front()];
+}
@@ -1,179 +1,1603 @@
 #include <iostream>
 #include <cmath>
+#include <limits>
+#include <algorithm>
+#include <type_traits>
 
 #include "App/Graph.hpp"
 
-#include "Vendor/tinyexpr.h"
+#include "Math/Expression.hpp"
 
 #include "System/Error.hpp"
+#include "System/Profiler.hpp"
+#include "System/ThreadPool.hpp"
 
-std::vector<sf::Vector2f> Graph::genratePoints(sampler_t sampler, double domainLeft, double domainRight) {
-    constexpr double IncrementSteps = 0.005;
+struct Sample {
+    double T;
+    sf::Vector2f Position;
+    bool Smooth{false}; // proven continuous up to the next sample
+};
 
+inline bool IsFinite(sf::Vector2f p) {
+    return std::isfinite(p.x) && std::isfinite(p.y);
+}
+
+// how far the midpoint sample strays from the chord between its neighbours,
+// or infinity when the segment needs splitting regardless of the geometry
+double RefinementError(sf::Vector2f a, sf::Vector2f m, sf::Vector2f b, const Graph::SamplingSettings& settings) {
+    const bool finiteA = IsFinite(a);
+    const bool finiteM = IsFinite(m);
+    const bool finiteB = IsFinite(b);
+
+    if (!finiteA || !finiteM || !finiteB) {
+        // refine towards the boundary of the defined region, nothing to do inside an undefined one
+        return (finiteA || finiteM || finiteB) ? std::numeric_limits<double>::infinity() : 0.0;
+    }
+
+    const double abx = b.x - a.x, aby = b.y - a.y;
+    const double amx = m.x - a.x, amy = m.y - a.y;
+    const double mbx = b.x - m.x, mby = b.y - m.y;
+
+    const double chordLength = std::sqrt(abx * abx + aby * aby);
+
+    const double deviation = chordLength > 0.0
+        ? std::fabs(abx * amy - aby * amx) / chordLength
+        : std::sqrt(amx * amx + amy * amy);
+
+    if (deviation > settings.Tolerance) {
+        return deviation;
+    }
+
+    const double lengthAM = std::sqrt(amx * amx + amy * amy);
+    const double lengthMB = std::sqrt(mbx * mbx + mby * mby);
+
+    if (lengthAM > settings.Tolerance && lengthMB > settings.Tolerance) {
+        const double bendCosine = (amx * mbx + amy * mby) / (lengthAM * lengthMB);
+
+        if (bendCosine < settings.MinBendCosine) {
+            // scale into the same unit as the deviation so both criteria rank together under the budget
+            return settings.Tolerance * (1.0 + settings.MinBendCosine - bendCosine);
+        }
+    }
+
+    return 0.0;
+}
+
+// samplers of explicit graphs are resampled per viewport, the ones with bounds can skip parts of it
+template <typename Sampler>
+concept Resampled = requires { Sampler::Along; };
+
+template <typename Sampler>
+concept Bounded = requires(const Sampler& sampler, Math::Interval t) {
+    { sampler.Enclose(t) } -> std::same_as<Graph::Bounds>;
+};
+
+// set by a job that is no longer wanted, null for work that always runs to the end
+inline bool IsCancelled(const std::atomic<bool>* cancelled) noexcept {
+    return cancelled && cancelled->load(std::memory_order_relaxed);
+}
+
+// splits large batches of reentrant samplers across the shared thread pool, chunks are disjoint so the result matches a serial run;
+// once cancelled the remaining chunks are skipped and their points left as they were
+template <typename Sampler>
+void RunSampler(const Sampler& sampler, const double* t, sf::Vector2f* points, std::size_t count, const std::atomic<bool>* cancelled = nullptr) {
+    constexpr std::size_t Grain = 4u * Math::Expression::BatchSize;
+
+    if (!Sampler::Reentrant || count <= Grain) {
+        sampler(t, points, count);
+        return;
+    }
+
+    System::ThreadPool::Shared().ParallelFor(count, Grain, [&](std::size_t begin, std::size_t end) {
+        if (!IsCancelled(cancelled)) {
+            sampler(t + begin, points + begin, end - begin);
+        }
+    });
+}
+
+inline double Distance(sf::Vector2f a, sf::Vector2f b) {
+    const double dx = static_cast<double>(b.x) - a.x;
+    const double dy = static_cast<double>(b.y) - a.y;
+
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// Turns samples into polyline runs separated by a single non-finite point.
+// Segments that are much longer than their neighbours and segments at the edge of an undefined region are bisected
+// in the parameter: a gap that does not close as the interval shrinks is a jump, so the curve is split there,
+// and the edge of an undefined region gets a sample right at its boundary.
+template <typename Sampler>
+std::vector<sf::Vector2f> SplitDiscontinuities(const Sampler& sampler, const std::vector<Sample>& samples, double tolerance, const std::atomic<bool>* cancelled = nullptr) {
+    constexpr unsigned int Iterations = 48u;
+    constexpr double JumpRatio = 2.0;      // against the longer neighbour
+    constexpr double MinJumpLength = 16.0; // in units of the tolerance
+
+    struct Bracket {
+        std::size_t Segment;
+        bool Jump;
+        Sample A;
+        Sample B;
+    };
+
+    std::vector<Bracket> brackets;
+
+    // zero for segments that touch an undefined sample or lie outside the samples
+    const auto direction = [&](std::size_t i, std::ptrdiff_t offset) {
+        const std::ptrdiff_t j = static_cast<std::ptrdiff_t>(i) + offset;
+
+        if (j < 0 || static_cast<std::size_t>(j) + 1u >= samples.size()) {
+            return sf::Vector2f();
+        }
+
+        const sf::Vector2f a = samples[static_cast<std::size_t>(j)].Position;
+        const sf::Vector2f b = samples[static_cast<std::size_t>(j) + 1u].Position;
+
+        return IsFinite(a) && IsFinite(b) ? b - a : sf::Vector2f();
+    };
+
+    const auto length = [](sf::Vector2f d) {
+        return std::sqrt(static_cast<double>(d.x) * d.x + static_cast<double>(d.y) * d.y);
+    };
+
+    const auto dot = [](sf::Vector2f a, sf::Vector2f b) {
+        return static_cast<double>(a.x) * b.x + static_cast<double>(a.y) * b.y;
+    };
+
+    for (std::size_t i = 0u; i + 1u < samples.size(); ++i) {
+        if (samples[i].Smooth) {
+            continue;
+        }
+
+        const bool finiteA = IsFinite(samples[i].Position);
+        const bool finiteB = IsFinite(samples[i + 1u].Position);
+
+        if (finiteA != finiteB) {
+            brackets.push_back({i, false, samples[i], samples[i + 1u]});
+        } else if (finiteA) {
+            const sf::Vector2f current = direction(i, 0);
+            const sf::Vector2f previous = direction(i, -1);
+            const sf::Vector2f next = direction(i, 1);
+
+            if (length(current) <= MinJumpLength * tolerance) {
+                continue;
+            }
+
+            // a step stands out by length, an asymptote like tan's runs against the curve on both sides
+            const bool stands = length(current) > JumpRatio * std::max(length(previous), length(next));
+            const bool reverses = dot(current, previous) < 0.0 && dot(current, next) < 0.0;
+
+            if (stands || reverses) {
+                brackets.push_back({i, true, samples[i], samples[i + 1u]});
+            }
+        }
+    }
+
+    // all brackets advance together so every iteration is one batch
+    std::vector<double> parameters;
+    std::vector<sf::Vector2f> positions;
+
+    for (unsigned int iteration = 0u; iteration < Iterations && !brackets.empty() && !IsCancelled(cancelled); ++iteration) {
+        parameters.clear();
+
+        for (const Bracket& bracket : brackets) {
+            parameters.push_back((bracket.A.T + bracket.B.T) * 0.5);
+        }
+
+        positions.resize(parameters.size());
+        RunSampler(sampler, parameters.data(), positions.data(), parameters.size(), cancelled);
+
+        for (std::size_t j = 0u; j < brackets.size(); ++j) {
+            Bracket& bracket = brackets[j];
+            const Sample middle = {parameters[j], positions[j]};
+
+            if (middle.T == bracket.A.T || middle.T == bracket.B.T) {
+                continue; // out of precision
+            }
+
+            if (bracket.Jump) {
+                if (!IsFinite(middle.Position)) {
+                    // the jump crosses an undefined point, that is a break already
+                    bracket.B = middle;
+                } else if (Distance(bracket.A.Position, middle.Position) > Distance(middle.Position, bracket.B.Position)) {
+                    bracket.B = middle;
+                } else {
+                    bracket.A = middle;
+                }
+            } else {
+                (IsFinite(middle.Position) == IsFinite(bracket.A.Position) ? bracket.A : bracket.B) = middle;
+            }
+        }
+    }
+
+    // extra points to insert after each sample, a NaN marks a break
+    constexpr float Break = std::numeric_limits<float>::quiet_NaN();
+
+    std::vector<std::vector<sf::Vector2f>> inserts(samples.size());
+
+    for (const Bracket& bracket : brackets) {
+        std::vector<sf::Vector2f>& insert = inserts[bracket.Segment];
+
+        if (!bracket.Jump) {
+            insert.push_back(IsFinite(bracket.A.Position) ? bracket.A.Position : bracket.B.Position);
+        } else if (!IsFinite(bracket.B.Position) || Distance(bracket.A.Position, bracket.B.Position) > tolerance) {
+            insert.push_back(bracket.A.Position);
+            insert.push_back({Break, Break});
+
+            if (IsFinite(bracket.B.Position)) {
+                insert.push_back(bracket.B.Position);
+            }
+        }
+    }
+
+    // collapse undefined stretches into a single separator, none at either end
     std::vector<sf::Vector2f> points;
-    points.reserve(1u + static_cast<size_t>((domainRight - domainLeft) / IncrementSteps));
+    points.reserve(samples.size() + brackets.size() * 3u);
+
+    const auto append = [&](sf::Vector2f p) {
+        if (IsFinite(p)) {
+            points.push_back(p);
+        } else if (!points.empty() && IsFinite(points.back())) {
+            points.push_back({Break, Break});
+        }
+    };
+
+    for (std::size_t i = 0u; i < samples.size(); ++i) {
+        append(samples[i].Position);
+
+        for (sf::Vector2f p : inserts[i]) {
+            append(p);
+        }
+    }
+
+    if (!points.empty() && !IsFinite(points.back())) {
+        points.pop_back();
+    }
+
+    return points;
+}
+
+float SegmentDistance(sf::Vector2f p, sf::Vector2f a, sf::Vector2f b) {
+    const sf::Vector2f ab = b - a;
+    const sf::Vector2f ap = p - a;
+
+    const float lenSquare = ab.x * ab.x + ab.y * ab.y;
+    const float t = lenSquare > 0.f ? std::clamp((ap.x * ab.x + ap.y * ab.y) / lenSquare, 0.f, 1.f) : 0.f;
+
+    const sf::Vector2f d = ap - ab * t;
+    return std::sqrt(d.x * d.x + d.y * d.y);
+}
+
+// Ramer-Douglas-Peucker run once for every tolerance: a point survives simplification with tolerance e
+// exactly when its significance is above e. Run ends and non-finite points are always kept.
+std::vector<float> PolylineSignificance(const std::vector<sf::Vector2f>& points) {
+    constexpr float Always = std::numeric_limits<float>::infinity();
+
+    struct Span {
+        std::size_t First;
+        std::size_t Last;
+        float Limit; // significance of the point that created the span, children never exceed it
+    };
+
+    std::vector<float> significance(points.size(), 0.f);
+    std::vector<Span> stack;
+
+    std::size_t runStart = 0u;
+
+    for (std::size_t i = 0u; i <= points.size(); ++i) {
+        if (i < points.size() && IsFinite(points[i])) {
+            continue;
+        }
+
+        if (i < points.size()) {
+            significance[i] = Always;
+        }
+
+        if (i > runStart) {
+            significance[runStart] = Always;
+            significance[i - 1u] = Always;
+
+            stack.push_back({runStart, i - 1u, Always});
+        }
+
+        runStart = i + 1u;
+
+        while (!stack.empty()) {
+            const Span span = stack.back();
+            stack.pop_back();
+
+            if (span.Last <= span.First + 1u) {
+                continue;
+            }
+
+            float farthest = -1.f;
+            std::size_t index = span.First + 1u;
+
+            for (std::size_t j = span.First + 1u; j < span.Last; ++j) {
+                const float distance = SegmentDistance(points[j], points[span.First], points[span.Last]);
+
+                if (distance > farthest) {
+                    farthest = distance;
+                    index = j;
+                }
+            }
+
+            const float value = std::min(farthest, span.Limit);
+            significance[index] = value;
+
+            stack.push_back({span.First, index, value});
+            stack.push_back({index, span.Last, value});
+        }
+    }
+
+    return significance;
+}
+
+template <typename Sampler>
+std::vector<sf::Vector2f> Graph::genratePoints(const Sampler& sampler, double domainLeft, double domainRight, const SamplingSettings& settings, const std::atomic<bool>* cancelled) {
+    const unsigned int initialSegments = std::max(1u, settings.InitialSegments);
+    const double initialStep = (domainRight - domainLeft) / initialSegments;
+
+    // parameters and positions of each batch handed to the sampler
+    std::vector<double> parameters(initialSegments + 1u);
+    std::vector<sf::Vector2f> positions(initialSegments + 1u);
+
+    for (unsigned int i = 0u; i <= initialSegments; ++i) {
+        parameters[i] = i == initialSegments ? domainRight : domainLeft + initialStep * i;
+    }
+
+    RunSampler(sampler, parameters.data(), positions.data(), parameters.size(), cancelled);
+
+    if (IsCancelled(cancelled)) {
+        return {};
+    }
+
+    std::vector<Sample> samples;
+    samples.reserve(initialSegments + 1u);
+
+    for (unsigned int i = 0u; i <= initialSegments; ++i) {
+        samples.push_back({parameters[i], positions[i]});
+    }
+
+    // every segment [i, i + 1] starts out as a candidate for subdivision
+    std::vector<bool> active(samples.size() - 1u, true);
+
+    std::vector<Sample> midpoints;
+    std::vector<double> errors;
+    std::vector<std::size_t> segments;
+
+    std::vector<Sample> refined;
+    std::vector<bool> refinedActive;
+
+    for (unsigned int depth = 0u; depth < settings.MaxDepth && samples.size() < settings.PointBudget; ++depth) {
+        if (IsCancelled(cancelled)) {
+            return {};
+        }
+
+        midpoints.assign(active.size(), Sample{});
+        errors.assign(active.size(), 0.0);
+
+        // evaluate the midpoints of every active segment in one batch
+        segments.clear();
+        parameters.clear();
+
+        for (std::size_t i = 0u; i < active.size(); ++i) {
+            if (active[i]) {
+                segments.push_back(i);
+                parameters.push_back((samples[i].T + samples[i + 1u].T) * 0.5);
+            }
+        }
+
+        positions.resize(parameters.size());
+        RunSampler(sampler, parameters.data(), positions.data(), parameters.size(), cancelled);
+
+        std::size_t failing = 0u;
+
+        for (std::size_t j = 0u; j < segments.size(); ++j) {
+            const std::size_t i = segments[j];
+
+            midpoints[i] = {parameters[j], positions[j]};
+            errors[i] = RefinementError(samples[i].Position, midpoints[i].Position, samples[i + 1u].Position, settings);
+
+            failing += errors[i] > 0.0;
+        }
+
+        if (!failing) {
+            break;
+        }
+
+        // over budget, only split the segments with the worst error
+        double threshold = 0.0;
+        const std::size_t remaining = settings.PointBudget - samples.size();
+
+        if (failing > remaining) {
+            std::vector<double> sorted(errors);
+            std::nth_element(sorted.begin(), sorted.begin() + remaining, sorted.end(), std::greater<double>());
+            threshold = sorted[remaining];
+        }
+
+        refined.clear();
+        refinedActive.clear();
+
+        refined.reserve(samples.size() + std::min(failing, remaining));
+        refinedActive.reserve(active.size() + std::min(failing, remaining));
+
+        for (std::size_t i = 0u; i < active.size(); ++i) {
+            refined.push_back(samples[i]);
+
+            if (errors[i] > threshold) {
+                refined.push_back(midpoints[i]);
+                refinedActive.push_back(true);
+                refinedActive.push_back(true);
+            } else {
+                refinedActive.push_back(false);
+            }
+        }
+
+        refined.push_back(samples.back());
+
+        samples.swap(refined);
+        active.swap(refinedActive);
+    }
+
+    std::vector<sf::Vector2f> points = SplitDiscontinuities(sampler, samples, settings.Tolerance, cancelled);
+
+    if (IsCancelled(cancelled)) {
+        return {};
+    }
+
+    return points;
+}
+
+template <Axis A>
+void Graph::ExplicitSampler<A>::operator()(const double* t, sf::Vector2f* points, std::size_t count) const {
+    // every call gets its own evaluation context, so chunks of a domain can be sampled concurrently
+    Math::Expression::Context context = Function->CreateContext();
+
+    std::vector<double> values(count);
+    Function->Evaluate(context, t, values.data(), count);
+
+    for (std::size_t i = 0u; i < count; ++i) {
+        if constexpr (A == Axis::Y) {
+            points[i] = sf::Vector2f(static_cast<float>(t[i]), static_cast<float>(-values[i]));
+        } else {
+            points[i] = sf::Vector2f(static_cast<float>(values[i]), static_cast<float>(t[i]));
+        }
+    }
+}
+
+template <Axis A>
+Graph::Bounds Graph::ExplicitSampler<A>::Enclose(Math::Interval t) const {
+    Math::Expression::Context context = Function->CreateContext();
+
+    const Math::IntervalValue parameter = Math::IntervalValue::Variable(t, true);
+    const Math::IntervalValue value = Function->EvaluateInterval(context, &t);
+
+    if constexpr (A == Axis::Y) {
+        return {parameter, Math::Apply(Math::OpCode::Neg, value, value)};
+    } else {
+        return {value, parameter};
+    }
+}
+
+void Graph::ParametricSampler::operator()(const double* t, sf::Vector2f* points, std::size_t count) const {
+    Math::Expression::Context context = Functions->CreateContext();
+
+    std::vector<double> xs(count);
+    std::vector<double> ys(count);
+
+    double* const outputs[] = {xs.data(), ys.data()};
+    Functions->Evaluate(context, &t, outputs, count);
+
+    for (std::size_t i = 0u; i < count; ++i) {
+        points[i] = {static_cast<float>(xs[i]), static_cast<float>(-ys[i])};
+    }
+}
+
+template <Axis A>
+void Graph::ExplicitCallbackSampler<A>::operator()(const double* t, sf::Vector2f* points, std::size_t count) const {
+    for (std::size_t i = 0u; i < count; ++i) {
+        const double r = Function(t[i]);
+
+        if constexpr (A == Axis::Y) {
+            points[i] = sf::Vector2f(static_cast<float>(t[i]), static_cast<float>(-r));
+        } else {
+            points[i] = sf::Vector2f(static_cast<float>(r), static_cast<float>(t[i]));
+        }
+    }
+}
+
+void Graph::ParametricCallbackSampler::operator()(const double* t, sf::Vector2f* points, std::size_t count) const {
+    for (std::size_t i = 0u; i < count; ++i) {
+        const sf::Vector2f p = Function(t[i]);
+        points[i] = sf::Vector2f(p.x, -p.y);
+    }
+}
+
+struct FieldFunctions {
+    Math::Contour::field_t Field;
+    Math::Contour::bounds_t Bounds;
+};
+
+System::Error::ResultWrapper<FieldFunctions> makeField(const std::string& equation) {
+    auto result = Math::Expression::Compile(equation, {"x", "y"});
+
+    if (!result) {
+        return System::Error::failure<FieldFunctions>("Could't parse the expression, " + result.error());
+    }
+
+    const Math::Expression& expr = result.value();
+
+    // evaluated in the same flipped space the other graphs are stored in, screen y points down
+    return System::Error::success(FieldFunctions{
+        [expr](const double* x, const double* y, double* values, std::size_t count) {
+            Math::Expression::Context context = expr.CreateContext();
+
+            std::vector<double> flipped(count);
+
+            for (std::size_t i = 0u; i < count; ++i) {
+                flipped[i] = -y[i];
+            }
+
+            const double* inputs[] = {x, flipped.data()};
+            expr.Evaluate(context, inputs, values, count);
+        },
+        [expr](Math::Interval x, Math::Interval y) {
+            Math::Expression::Context context = expr.CreateContext();
+
+            const Math::Interval inputs[] = {x, {-y.Hi, -y.Lo}};
+            return expr.EvaluateInterval(context, inputs).Value;
+        }
+    });
+}
+
+void Graph::setSampler(sampler_t sampler, std::vector<Math::Expression> expressions, double domainLeft, double domainRight, std::optional<Curve> cached, const std::atomic<bool>* cancelled) {
+    if (cached) {
+        m_Points = std::move(cached->Points);
+        m_Lod = std::move(cached->Lod);
+        measureLod();
+        m_GeometryDirty = true;
+    } else {
+        m_Points = std::visit([&](const auto& typed) {
+            if constexpr (std::is_same_v<std::decay_t<decltype(typed)>, std::monostate>) {
+                return std::vector<sf::Vector2f>();
+            } else {
+                return genratePoints(typed, domainLeft, domainRight, m_Sampling, cancelled);
+            }
+        }, sampler);
+
+        buildLod();
+    }
+
+    m_Sampler = std::move(sampler);
+    m_Expressions = std::move(expressions);
+    m_DomainLeft = domainLeft;
+    m_DomainRight = domainRight;
+
+    m_CacheSamples.clear();
+    m_CacheLevel = std::numeric_limits<int>::min();
+    m_Viewport.reset();
+
+    m_Field = nullptr;
+    m_FieldBounds = nullptr;
+    m_Tiles.clear();
+    m_TileLevel = std::numeric_limits<int>::min();
+
+    m_Heatmap.reset();
+}
+
+void Graph::setField(Math::Contour::field_t field, Math::Contour::bounds_t bounds) {
+    m_Points.clear();
+    buildLod();
+
+    m_Sampler = std::monostate();
+    m_Expressions.clear();
+    m_CacheSamples.clear();
+    m_CacheLevel = std::numeric_limits<int>::min();
+    m_Viewport.reset();
+
+    m_Field = std::move(field);
+    m_FieldBounds = std::move(bounds);
+    m_Tiles.clear();
+    m_TileLevel = std::numeric_limits<int>::min();
+
+    m_Heatmap.reset();
+}
+
+void Graph::setHeatmap(Heatmap::field_t field) {
+    setField(nullptr, nullptr);
+
+    m_Heatmap = std::make_unique<Heatmap>(std::move(field));
+}
+
+std::optional<std::string> Graph::Generate(const Equation& equation) {
+    return generate(equation, std::nullopt);
+}
+
+std::optional<std::string> Graph::Restore(std::string source, Curve curve) {
+    auto equation = Equation::Parse(source);
+
+    if (!equation) {
+        return equation.error();
+    }
+
+    m_Source = std::move(source);
+
+    const std::optional<Viewport> viewport = curve.View;
+
+    if (auto error = generate(equation.value(), std::move(curve))) {
+        return error;
+    }
+
+    // the points already belong to this view, the first UpdateViewport for it finds nothing to do
+    m_Viewport = viewport;
+
+    return std::nullopt;
+}
+
+std::optional<std::string> Graph::generate(const Equation& equation, std::optional<Curve> cached, const std::atomic<bool>* cancelled) {
+    PROFILE_SCOPE("Graph::Generate");
+
+    if (equation.Type == EquationType::ScalarField) {
+        auto result = makeField(equation.Expression_1);
+
+        if (result) {
+            setHeatmap(result.value().Field);
+            return std::nullopt;
+        } else {
+            return result.error();
+        }
+    } else if (equation.Type == EquationType::Implicit) {
+        auto result = makeField(equation.Expression_1);
+
+        if (result) {
+            setField(result.value().Field, result.value().Bounds);
+
+            // a restored contour stays until the view changes, tiles are traced from then on
+            if (cached) {
+                m_Points = std::move(cached->Points);
+                m_Lod = std::move(cached->Lod);
+                measureLod();
+                m_GeometryDirty = true;
+            }
+
+            return std::nullopt;
+        } else {
+            return result.error();
+        }
+    } else if (equation.Type == EquationType::Parametric) {
+        // one program for both coordinates, so subexpressions they share are evaluated once per sample
+        auto result = Math::Expression::Compile(std::vector<std::string>{equation.Expression_1, equation.Expression_2}, {"t"});
+
+        if (!result) {
+            return "Could't parse the parametric expressions, " + result.error();
+        }
+
+        std::vector<Math::Expression> expressions;
+        expressions.push_back(std::move(result).value());
+
+        const ParametricSampler sampler{&expressions.front()};
+        setSampler(sampler, std::move(expressions), equation.DomainLeft, equation.DomainRight, std::move(cached), cancelled);
+        return std::nullopt;
+    } else {
+        auto result = Math::Expression::Compile(equation.Expression_1, {"x"});
+
+        if (!result) {
+            return "Could't parse the expression, " + result.error();
+        }
+
+        std::vector<Math::Expression> expressions;
+        expressions.push_back(std::move(result).value());
+
+        const Math::Expression* function = &expressions.front();
+
+        if (equation.Type == EquationType::Explicit_X) {
+            setSampler(ExplicitSampler<Axis::X>{function}, std::move(expressions), equation.DomainLeft, equation.DomainRight, std::move(cached), cancelled);
+        } else {
+            setSampler(ExplicitSampler<Axis::Y>{function}, std::move(expressions), equation.DomainLeft, equation.DomainRight, std::move(cached), cancelled);
+        }
+
+        return std::nullopt;
+    }
+}
+
+void Graph::GenerateAsync(std::string source) {
+    const SamplingSettings sampling = m_Sampling;
+
+    m_Source = source;
+
+    m_Job = System::Job<System::Error::ResultWrapper<Graph>>::Run(
+        System::ThreadPool::Shared(),
+        [source = std::move(source), sampling](const std::atomic<bool>& cancelled) -> std::optional<System::Error::ResultWrapper<Graph>> {
+            auto equation = Equation::Parse(source);
+            if (!equation) {
+                return System::Error::failure<Graph>(equation.error());
+            }
+
+            if (cancelled.load(std::memory_order_relaxed)) {
+                return std::nullopt;
+            }
+
+            Graph graph;
+            graph.SetSamplingSettings(sampling);
+            graph.m_Source = source;
+
+            // sampling gives up between batches once the job is replaced, what it leaves behind is dropped
+            if (auto error = graph.generate(equation.value(), std::nullopt, &cancelled)) {
+                return System::Error::failure<Graph>(error.value());
+            }
+
+            if (cancelled.load(std::memory_order_relaxed)) {
+                return std::nullopt;
+            }
+
+            return System::Error::success(std::move(graph));
+        }
+    );
+}
+
+void Graph::LoadDataAsync(std::string path) {
+    m_Source.clear();
+
+    m_Job = System::Job<System::Error::ResultWrapper<Graph>>::Run(
+        System::ThreadPool::Shared(),
+        [path = std::move(path), decimation = m_Decimation](const std::atomic<bool>& cancelled) -> std::optional<System::Error::ResultWrapper<Graph>> {
+            auto series = DataSeries::Load(path, &cancelled);
+
+            if (cancelled.load(std::memory_order_relaxed)) {
+                return std::nullopt;
+            }
+
+            if (!series) {
+                return System::Error::failure<Graph>(series.error());
+            }
+
+            Graph graph;
+            graph.m_Data = std::make_shared<const DataSeries>(std::move(series).value());
+            graph.m_Decimation = decimation;
+
+            return System::Error::success(std::move(graph));
+        }
+    );
+}
+
+std::optional<std::string> Graph::OpenStream(const std::string& path, double window, Stream::Overflow overflow) {
+    auto stream = Stream::Open(path, window, overflow);
+
+    if (!stream) {
+        return stream.error();
+    }
+
+    *this = Graph(false);
+    m_Stream = std::move(stream).value();
+
+    return std::nullopt;
+}
+
+void Graph::appendStream() {
+    // the provisional tail of the last frame goes, along with the segments built on it
+    if (m_StreamTail) {
+        m_Points.resize(m_Points.size() - m_StreamTail);
+        m_StreamFirst = std::min(m_StreamFirst, m_Points.size());
+        m_StreamTail = 0u;
+
+        if (m_GeometryPoints > m_Points.size()) {
+            while (!m_GeometrySegmentEnds.empty() && m_GeometrySegmentEnds.back() >= m_Points.size()) {
+                m_GeometrySegmentEnds.pop_back();
+            }
+
+            // a vertex buffer is simply overwritten past the kept segments
+            if (!m_Geometry) {
+                m_FallbackGeometry.resize(m_GeometrySegmentEnds.size() * 6u);
+            }
+
+            m_GeometryPoints = m_Points.size();
+        }
+    }
+
+    m_Stream->Drain(m_Points);
+
+    // the newest samples are drawn right away rather than once their bucket is complete
+    const std::size_t drained = m_Points.size();
+    m_Stream->Tail(m_Points);
+    m_StreamTail = m_Points.size() - drained;
+
+    // the last point before the window stays, so the line runs off the edge of it
+    const double oldest = m_Stream->GetLatest() - m_Stream->GetWindow();
+
+    while (m_StreamFirst + 1u < m_Points.size() && m_Points[m_StreamFirst + 1u].x < oldest) {
+        ++m_StreamFirst;
+    }
+
+    // points that scrolled out are dropped once they are half of all of them, so that costs constant time per point;
+    // x moves back to near zero along with it, so floats keep their precision however long the stream runs
+    if (m_StreamFirst >= Stream::BucketsPerWindow && 2u * m_StreamFirst >= m_Points.size()) {
+        const float shift = static_cast<float>(m_Stream->Rebase(m_Points[m_StreamFirst].x));
+
+        m_Points.erase(m_Points.begin(), m_Points.begin() + static_cast<std::ptrdiff_t>(m_StreamFirst));
+
+        for (sf::Vector2f& point : m_Points) {
+            point.x -= shift;
+        }
+
+        m_StreamFirst = 0u;
+        m_GeometryDirty = true;
+    }
+}
+
+void Graph::SetDecimation(DataSeries::Decimation decimation) noexcept {
+    if (m_Decimation != decimation) {
+        m_Decimation = decimation;
+        m_Viewport.reset();
+    }
+}
+
+std::optional<std::string> Graph::PollGeneration() {
+    if (!m_Job.IsFinished()) {
+        return std::nullopt;
+    }
+
+    auto result = m_Job.Take();
+
+    if (!result) {
+        return std::nullopt;
+    }
+
+    if (!result.value()) {
+        return result.value().error();
+    }
+
+    // swap the samples in on the render thread, the reveal animation starts from here
+    const float progress = m_Progress;
+    const SamplingSettings sampling = m_Sampling;
+
+    *this = std::move(result).value().value();
+
+    m_Progress = progress;
+    m_Sampling = sampling;
+
+    return std::nullopt;
+}
+
+void Graph::SetExplicitCallback(func_explicit_t function, double domainLeft, double domainRight, Axis axis) {
+    m_Source.clear();
+
+    if (axis == Axis::X) {
+        setSampler(ExplicitCallbackSampler<Axis::X>{std::move(function)}, {}, domainLeft, domainRight, std::nullopt);
+    } else {
+        setSampler(ExplicitCallbackSampler<Axis::Y>{std::move(function)}, {}, domainLeft, domainRight, std::nullopt);
+    }
+}
+
+void Graph::SetParametricCallback(func_parametric_t function, double domainLeft, double domainRight) {
+    m_Source.clear();
+    setSampler(ParametricCallbackSampler{std::move(function)}, {}, domainLeft, domainRight, std::nullopt);
+}
+
+void Graph::UpdateViewport(const Viewport& viewport) {
+    PROFILE_SCOPE("Graph::UpdateViewport");
+
+    if (viewport.Zoom <= 0.f || !viewport.Size.x || !viewport.Size.y) {
+        return;
+    }
+
+    const bool resampled = std::visit([](const auto& sampler) {
+        return Resampled<std::decay_t<decltype(sampler)>>;
+    }, m_Sampler);
+
+    if (!m_Field && !m_Data && !resampled) {
+        return;
+    }
+
+    if (
+        m_Viewport &&
+        m_Viewport->Offset == viewport.Offset &&
+        m_Viewport->Size == viewport.Size &&
+        m_Viewport->Zoom == viewport.Zoom
+    ) {
+        return;
+    }
+
+    m_Viewport = viewport;
 
-    for (double t = domainLeft; t <= domainRight; t += IncrementSteps) {
-        points.emplace_back(sampler(t));
+    if (m_Field) {
+        updateContour(viewport);
+        return;
     }
 
-    return points;
+    if (m_Data) {
+        decimate(viewport);
+        return;
+    }
+
+    std::visit([&](const auto& sampler) {
+        if constexpr (Resampled<std::decay_t<decltype(sampler)>>) {
+            resample(sampler, viewport);
+        }
+    }, m_Sampler);
 }
 
-System::Error::ResultWrapper<Graph::sampler_t> makeExplicitSampler(const std::string& equation, Axis axis) {
-    auto value = std::make_shared<double>();
+template <typename Sampler>
+void Graph::resample(const Sampler& sampler, const Viewport& viewport) {
+    // extra samples kept on each side of the screen so small pans stay within the cache
+    constexpr int64_t Margin = 64;
 
-    te_variable vars[] = {
-        {"x", value.get(), TE_VARIABLE}
-    };
+    // grid steps covered by one interval evaluation
+    constexpr int64_t BlockSize = 32;
+
+    // the domain variable runs along screen x for y = f(x) and along screen y for x = f(y)
+    constexpr bool alongX = Sampler::Along == Axis::Y;
+    const double extent = alongX ? viewport.Size.x : viewport.Size.y;
+    const double offset = alongX ? viewport.Offset.x : viewport.Offset.y;
 
-    int error = 0;
-    te_expr* raw = te_compile(equation.c_str(), vars, 1, &error);
+    const double viewLeft = (-0.5 * extent - offset) / viewport.Zoom;
+    const double viewRight = (0.5 * extent - offset) / viewport.Zoom;
 
-    if (!raw) {
-        te_free(raw);
-        return System::Error::failure<Graph::sampler_t>("Could't parse the expression, error at position: " + std::to_string(error));
+    // power of two step between half a pixel and a pixel, so zooming within an octave keeps the grid
+    const int level = static_cast<int>(std::floor(std::log2(1.0 / viewport.Zoom)));
+    const double step = std::ldexp(1.0, level);
+
+    const double left = std::max(m_DomainLeft, viewLeft - Margin * step);
+    const double right = std::min(m_DomainRight, viewRight + Margin * step);
+
+    if (left > right) {
+        m_Points.clear();
+        buildLod();
+        return;
+    }
+
+    const int64_t first = static_cast<int64_t>(std::ceil(left / step));
+    const int64_t last = static_cast<int64_t>(std::floor(right / step));
+
+    if (first > last) {
+        m_Points.clear();
+        buildLod();
+        return;
     }
 
-    auto expr = std::shared_ptr<te_expr>(raw, te_free);
+    // blocks of the grid the bounds are taken over, aligned to multiples of BlockSize so they stay put while panning
+    enum class Coverage : uint8_t {
+        Hidden,   // the whole block is off screen
+        Straight, // within a quarter pixel of the chord between its ends
+        Sampled
+    };
+
+    struct Block {
+        int64_t First;
+        int64_t Last;
+        Coverage Kind;
+    };
+
+    // the visible box in the space the sampler writes to, grown by the same margin
+    const auto visible = [&](double size, float offset) -> Math::Interval {
+        return {(-0.5 * size - offset) / viewport.Zoom - Margin * step, (0.5 * size - offset) / viewport.Zoom + Margin * step};
+    };
+
+    const Math::Interval visibleX = visible(viewport.Size.x, viewport.Offset.x);
+    const Math::Interval visibleY = visible(viewport.Size.y, viewport.Offset.y);
+
+    std::vector<Block> blocks;
+
+    for (int64_t start = first; start < last || blocks.empty(); ) {
+        const int64_t blockStart = start - ((start % BlockSize) + BlockSize) % BlockSize;
+        Block block = {start, std::min(last, blockStart + BlockSize), Coverage::Sampled};
+
+        if constexpr (Bounded<Sampler>) {
+            const double lo = block.First == first ? left : static_cast<double>(block.First) * step;
+            const double hi = block.Last == last ? right : static_cast<double>(block.Last) * step;
 
-    return System::Error::success<Graph::sampler_t>(
-        [expr, value, axis](double t) -> sf::Vector2f {
-            *value = t;
-            double r = te_eval(expr.get());
+            const Bounds bounds = sampler.Enclose({lo, hi});
 
-            return axis == Axis::Y
-                ? sf::Vector2f((float)t, (float)-r)
-                : sf::Vector2f((float)r, (float)t);
+            // the points stray from the chord by at most half the width of the slope times the length of the block
+            const double deviation = std::hypot(bounds.X.Slope.Width(), bounds.Y.Slope.Width()) * (hi - lo) * 0.5;
+
+            if (!bounds.X.Value.Intersects(visibleX.Lo, visibleX.Hi) || !bounds.Y.Value.Intersects(visibleY.Lo, visibleY.Hi)) {
+                block.Kind = Coverage::Hidden;
+            } else if (bounds.X.Continuous && bounds.Y.Continuous && deviation <= 0.25 / viewport.Zoom) {
+                block.Kind = Coverage::Straight;
             }
-    );
-}
+        }
+
+        blocks.push_back(block);
+        start = block.Last;
+
+        if (start == last) {
+            break;
+        }
+    }
 
-System::Error::ResultWrapper<Graph::sampler_t> makeParametricSampler(const std::string& eqX, const std::string& eqY) {
-    auto value = std::make_shared<double>();
+    const std::size_t count = static_cast<std::size_t>(last - first + 1);
+    std::vector<std::optional<sf::Vector2f>> samples(count);
 
-    te_variable vars[] = {
-        {"t", value.get(), TE_VARIABLE}
+    // reuse what the cache covers, evaluate the rest of what the blocks need in one batch
+    std::vector<double> parameters;
+    std::vector<std::size_t> missing;
+
+    const int64_t cachedLast = m_CacheFirst + static_cast<int64_t>(m_CacheSamples.size()) - 1;
+
+    if (level == m_CacheLevel) {
+        for (int64_t i = std::max(first, m_CacheFirst); i <= std::min(last, cachedLast); ++i) {
+            samples[static_cast<std::size_t>(i - first)] = m_CacheSamples[static_cast<std::size_t>(i - m_CacheFirst)];
+        }
+    }
+
+    const auto require = [&](int64_t i) {
+        const std::size_t index = static_cast<std::size_t>(i - first);
+
+        if (!samples[index] && (missing.empty() || missing.back() != index)) {
+            missing.push_back(index);
+            parameters.push_back(static_cast<double>(i) * step);
+        }
     };
 
-    int error = 0;
-    te_expr* rawX = te_compile(eqX.c_str(), vars, 1, &error);
+    for (const Block& block : blocks) {
+        if (block.Kind == Coverage::Sampled) {
+            for (int64_t i = block.First; i <= block.Last; ++i) {
+                require(i);
+            }
+        } else if (block.Kind == Coverage::Straight) {
+            require(block.First);
+            require(block.Last);
+        }
+    }
+
+    // the grid rarely lands on the domain bounds, sample them explicitly when they are in view
+    const bool leftBound = left == m_DomainLeft && static_cast<double>(first) * step != left && blocks.front().Kind != Coverage::Hidden;
+    const bool rightBound = right == m_DomainRight && static_cast<double>(last) * step != right && blocks.back().Kind != Coverage::Hidden;
+
+    if (leftBound) {
+        parameters.push_back(left);
+    }
 
-    if (!rawX) {
-        return System::Error::failure<Graph::sampler_t>("Could't parse the expression g(t), error at position: " + std::to_string(error));
+    if (rightBound) {
+        parameters.push_back(right);
     }
 
-    te_expr* rawY = te_compile(eqY.c_str(), vars, 1, &error);
+    std::vector<sf::Vector2f> positions(parameters.size());
+    RunSampler(sampler, parameters.data(), positions.data(), parameters.size());
 
-    if (!rawY) {
-        return System::Error::failure<Graph::sampler_t>("Could't parse the expression f(t), error at position: " + std::to_string(error));
+    for (std::size_t j = 0u; j < missing.size(); ++j) {
+        samples[missing[j]] = positions[j];
     }
 
-    auto ex = std::shared_ptr<te_expr>(rawX, te_free);
-    auto ey = std::shared_ptr<te_expr>(rawY, te_free);
+    const auto gridSample = [&](int64_t i) {
+        return Sample{static_cast<double>(i) * step, samples[static_cast<std::size_t>(i - first)].value()};
+    };
+
+    // hidden blocks split the curve, every stretch between them is checked for jumps on its own;
+    // a grid step is at most a pixel, so it doubles as the tolerance for jumps
+    constexpr float Break = std::numeric_limits<float>::quiet_NaN();
+
+    std::vector<sf::Vector2f> points;
+    std::vector<Sample> curve;
+    std::vector<Sample> blockSamples;
+
+    const auto flush = [&] {
+        const std::vector<sf::Vector2f> run = SplitDiscontinuities(sampler, curve, step);
 
-    return System::Error::success<Graph::sampler_t>(
-        [ex, ey, value](double t) -> sf::Vector2f {
-            *value = t;
-            return {
-                (float)te_eval(ex.get()),
-                (float)-te_eval(ey.get())
-            };
+        if (!run.empty()) {
+            if (!points.empty()) {
+                points.push_back({Break, Break});
             }
-    );
-}
 
-std::optional<std::string> Graph::Generate(const Equation& equation) {
-    if (equation.Type == EquationType::Parametric) {
-        auto result = makeParametricSampler(equation.Expression_1, equation.Expression_2);
+            points.insert(points.end(), run.begin(), run.end());
+        }
 
-        if (result) {
-            m_Points = genratePoints(result.value(), equation.DomainLeft, equation.DomainRight);
-            return std::nullopt;
-        } else {
-            return result.error();
+        curve.clear();
+    };
+
+    for (const Block& block : blocks) {
+        if (block.Kind == Coverage::Hidden) {
+            flush();
+            continue;
         }
-    } else {
-        auto result = makeExplicitSampler(equation.Expression_1, equation.Type == EquationType::Explicit_X ? Axis::X : Axis::Y);
 
-        if (result) {
-            m_Points = genratePoints(result.value(), equation.DomainLeft, equation.DomainRight);
-            return std::nullopt;
+        const bool withLeft = leftBound && block.First == first;
+        const bool withRight = rightBound && block.Last == last;
+
+        blockSamples.clear();
+
+        if (withLeft) {
+            blockSamples.push_back({left, positions[missing.size()]});
+        }
+
+        if (block.Kind == Coverage::Straight) {
+            if (!withLeft) {
+                blockSamples.push_back(gridSample(block.First));
+            }
+
+            blockSamples.push_back(withRight ? Sample{right, positions.back()} : gridSample(block.Last));
+            blockSamples.front().Smooth = true;
         } else {
-            return result.error();
+            for (int64_t i = block.First; i <= block.Last; ++i) {
+                blockSamples.push_back(gridSample(i));
+            }
+
+            if (withRight) {
+                blockSamples.push_back({right, positions.back()});
+            }
+        }
+
+        // consecutive blocks share their boundary sample
+        const bool shared = !curve.empty() && curve.back().T == blockSamples.front().T;
+
+        if (shared) {
+            curve.back().Smooth = blockSamples.front().Smooth;
         }
+
+        curve.insert(curve.end(), blockSamples.begin() + shared, blockSamples.end());
     }
+
+    flush();
+
+    m_Points = std::move(points);
+    buildLod();
+
+    m_CacheSamples = std::move(samples);
+    m_CacheFirst = first;
+    m_CacheLevel = level;
 }
 
-void Graph::SetExplicitCallback(func_explicit_t function, double domainLeft, double domainRight, Axis axis) {
-    m_Points = genratePoints(
-        [function, axis](double t) -> sf::Vector2f {
-            const double r = function(t);
-            return axis == Axis::Y ? sf::Vector2f(static_cast<float>(t), static_cast<float>(-r)) : sf::Vector2f(static_cast<float>(r), static_cast<float>(t));
-        },
-        domainLeft, domainRight
-    );
+void Graph::updateContour(const Viewport& viewport) {
+    // tiles kept on each side of the screen, so panning by less than a tile traces nothing new
+    constexpr int64_t Margin = 1;
+
+    // power of two coarse cell so the refined cells are between half a pixel and a pixel
+    const int level = static_cast<int>(std::floor(std::log2(Math::Contour::RefineFactor / viewport.Zoom)));
+    const double step = std::ldexp(1.0, level);
+    const double tileSize = step * Math::Contour::TileCells;
+
+    if (level != m_TileLevel) {
+        m_Tiles.clear();
+        m_TileLevel = level;
+    }
+
+    const auto tileRange = [&](double extent, double offset) {
+        const double low = (-0.5 * extent - offset) / viewport.Zoom;
+        const double high = (0.5 * extent - offset) / viewport.Zoom;
+
+        return std::pair<int64_t, int64_t>(
+            static_cast<int64_t>(std::floor(low / tileSize)) - Margin,
+            static_cast<int64_t>(std::floor(high / tileSize)) + Margin
+        );
+    };
+
+    const auto [firstX, lastX] = tileRange(viewport.Size.x, viewport.Offset.x);
+    const auto [firstY, lastY] = tileRange(viewport.Size.y, viewport.Offset.y);
+
+    std::erase_if(m_Tiles, [&](const auto& entry) {
+        const auto [tx, ty] = entry.first;
+        return tx < firstX || tx > lastX || ty < firstY || ty > lastY;
+    });
+
+    std::vector<std::pair<int64_t, int64_t>> missing;
+
+    for (int64_t ty = firstY; ty <= lastY; ++ty) {
+        for (int64_t tx = firstX; tx <= lastX; ++tx) {
+            if (!m_Tiles.contains({tx, ty})) {
+                missing.emplace_back(tx, ty);
+            }
+        }
+    }
+
+    // one tile per task, a tile is already a couple of thousand evaluations
+    if (!missing.empty()) {
+        std::vector<Math::Contour::Tile> traced(missing.size());
+
+        System::ThreadPool::Shared().ParallelFor(missing.size(), 1u, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                traced[i] = Math::Contour::TraceTile(m_Field, m_FieldBounds, step, missing[i].first, missing[i].second);
+            }
+        });
+
+        for (std::size_t i = 0u; i < missing.size(); ++i) {
+            m_Tiles.emplace(missing[i], std::move(traced[i]));
+        }
+    }
+
+    std::vector<const Math::Contour::Tile*> tiles;
+    tiles.reserve(m_Tiles.size());
+
+    for (const auto& [key, tile] : m_Tiles) {
+        tiles.push_back(&tile);
+    }
+
+    const std::vector<Math::Contour::Point> contour = Math::Contour::ChainSegments(tiles);
+
+    m_Points.clear();
+    m_Points.reserve(contour.size());
+
+    for (const Math::Contour::Point& p : contour) {
+        m_Points.emplace_back(static_cast<float>(p.X), static_cast<float>(p.Y));
+    }
+
+    buildLod();
 }
 
-void Graph::SetParametricCallback(func_parametric_t function, double domainLeft, double domainRight) {
-    m_Points = genratePoints(
-        [function](double t) -> sf::Vector2f {
-            sf::Vector2f p = function(t);
-            return sf::Vector2f(p.x, -p.y);
-        },
-        domainLeft, domainRight
+void Graph::decimate(const Viewport& viewport) {
+    // series up to this size are decimated in about a millisecond, right away
+    constexpr std::size_t SyncPoints = 1u << 18;
+
+    // at most two points per pixel column, however many the file holds
+    const double left = (-0.5 * viewport.Size.x - viewport.Offset.x) / viewport.Zoom;
+    const double right = (0.5 * viewport.Size.x - viewport.Offset.x) / viewport.Zoom;
+
+    // x is stored relative to the middle of the view, so the points keep their spacing however large x gets
+    const double origin = 0.5 * (left + right);
+
+    if (m_Data->GetSize() <= SyncPoints) {
+        m_DecimationJob.Cancel();
+        m_Points = m_Data->Decimate(left, right, viewport.Size.x, m_Decimation, origin);
+        m_DataOrigin = origin;
+        buildLod();
+        return;
+    }
+
+    // replacing the job cancels the one of the last viewport, Update swaps the points in once it finishes
+    m_DecimationJob = System::Job<Decimated>::Run(
+        System::ThreadPool::Shared(),
+        [data = m_Data, left, right, columns = viewport.Size.x, method = m_Decimation, origin](const std::atomic<bool>& cancelled) -> std::optional<Decimated> {
+            std::vector<sf::Vector2f> points = data->Decimate(left, right, columns, method, origin, &cancelled);
+
+            if (cancelled.load(std::memory_order_relaxed)) {
+                return std::nullopt;
+            }
+
+            return Decimated{std::move(points), origin};
+        }
     );
 }
 
+void Graph::UpdateHeatmap(const Viewport& viewport) {
+    if (m_Heatmap) {
+        m_Heatmap->Update(viewport.Offset, viewport.Size, viewport.Zoom);
+    }
+}
+
 void Graph::Update(float deltaTime) {
     constexpr float AnimationDuration = 1.f;
 
-    if (m_Progress < 1.f) {
+    if (m_Stream) {
+        appendStream();
+    }
+
+    if (m_DecimationJob.IsFinished()) {
+        if (auto decimated = m_DecimationJob.Take()) {
+            m_Points = std::move(decimated->Points);
+            m_DataOrigin = decimated->Origin;
+            buildLod();
+        }
+    }
+
+    if (m_Progress < 1.f && !IsPending()) {
         const float t = deltaTime / AnimationDuration;
         m_Progress = std::min<float>(1.f, m_Progress + t);
     }
 }
 
+void Graph::buildLod() {
+    constexpr float SimplifyTolerance = 0.25f; // pixels, well under the line thickness
+    constexpr int MaxLevels = 48;
+
+    m_Lod = LevelOfDetail();
+    m_LodMemory.clear();
+    m_GeometryDirty = true;
+
+    if (m_Points.empty()) {
+        return;
+    }
+
+    // first power of two zoom at which each point moves the line by more than the tolerance
+    const std::vector<float> significance = PolylineSignificance(m_Points);
+    std::vector<int> needed(m_Points.size());
+
+    int finest = std::numeric_limits<int>::min();
+    int coarsest = std::numeric_limits<int>::max();
+
+    for (std::size_t i = 0u; i < m_Points.size(); ++i) {
+        const float value = significance[i];
+
+        if (value == std::numeric_limits<float>::infinity()) {
+            needed[i] = std::numeric_limits<int>::min();
+        } else if (value > 0.f) {
+            needed[i] = static_cast<int>(std::ceil(std::log2(SimplifyTolerance / value)));
+            finest = std::max(finest, needed[i]);
+            coarsest = std::min(coarsest, needed[i]);
+        } else {
+            needed[i] = std::numeric_limits<int>::max();
+        }
+    }
+
+    if (finest == std::numeric_limits<int>::min()) {
+        finest = coarsest = 0;
+    }
+
+    coarsest = std::max(coarsest, finest - MaxLevels + 1);
+
+    m_Lod.Zoom = std::ldexp(1.f, coarsest);
+    m_Lod.LevelCount = static_cast<uint8_t>(finest - coarsest + 1);
+    m_Lod.Levels.resize(m_Points.size());
+
+    for (std::size_t i = 0u; i < m_Points.size(); ++i) {
+        if (needed[i] > finest) {
+            m_Lod.Levels[i] = LevelOfDetail::Never;
+        } else {
+            m_Lod.Levels[i] = static_cast<uint8_t>(std::max(needed[i], coarsest) - coarsest);
+        }
+    }
+
+    measureLod();
+}
+
+void Graph::measureLod() {
+    const std::size_t levelCount = m_Lod.LevelCount;
+    const std::size_t count = std::min(m_Lod.Levels.size(), m_Points.size());
+
+    // points, finite points and runs of finite points, each counted at the coarsest level it shows up at
+    std::vector<std::size_t> points(levelCount, 0u);
+    std::vector<std::size_t> finite(levelCount, 0u);
+    std::vector<std::size_t> runs(levelCount, 0u);
+
+    uint8_t runLevel = LevelOfDetail::Never;
+
+    for (std::size_t i = 0u; i <= count; ++i) {
+        if (i == count || !IsFinite(m_Points[i])) {
+            if (runLevel < levelCount) {
+                ++runs[runLevel];
+            }
+
+            runLevel = LevelOfDetail::Never;
+
+            if (i == count) {
+                break;
+            }
+        }
+
+        const uint8_t level = m_Lod.Levels[i];
+
+        if (level >= levelCount) {
+            continue;
+        }
+
+        ++points[level];
+
+        if (IsFinite(m_Points[i])) {
+            ++finite[level];
+            runLevel = std::min(runLevel, level);
+        }
+    }
+
+    // level k draws every point of the levels up to it, and a segment between each two finite points of a run
+    m_LodMemory.resize(levelCount);
+
+    std::size_t levelPoints = 0u;
+    std::size_t levelFinite = 0u;
+    std::size_t levelRuns = 0u;
+
+    for (std::size_t k = 0u; k < levelCount; ++k) {
+        levelPoints += points[k];
+        levelFinite += finite[k];
+        levelRuns += runs[k];
+
+        m_LodMemory[k] = {levelPoints, levelPoints * sizeof(sf::Vector2f) + (levelFinite - levelRuns) * 6u * sizeof(sf::Vertex)};
+    }
+}
+
+// two triangles along p0 -> p1 that are `halfThickness` to either side, false when there is nothing to draw
+bool ExtrudeSegment(sf::Vector2f p0, sf::Vector2f p1, float halfThickness, float zoom, sf::Color color, std::vector<sf::Vertex>& vertices) {
+    if (!IsFinite(p0) || !IsFinite(p1)) {
+        return false;
+    }
+
+    const sf::Vector2f p01 = p1 - p0;
+    const float lenSquare = p01.x * p01.x + p01.y * p01.y;
+
+    // measured in pixels
+    if (lenSquare * zoom * zoom < 1e-6f) [[unlikely]] {
+        return false;
+    }
+
+    const sf::Vector2f dir = p01 / std::sqrt(lenSquare);
+
+    const sf::Vector2f normalOffset = sf::Vector2f(-dir.y, dir.x) * halfThickness;
+
+    vertices.emplace_back(p0 + normalOffset, color);
+    vertices.emplace_back(p1 + normalOffset, color);
+    vertices.emplace_back(p1 - normalOffset, color);
+
+    vertices.emplace_back(p0 + normalOffset, color);
+    vertices.emplace_back(p1 - normalOffset, color);
+    vertices.emplace_back(p0 - normalOffset, color);
+
+    return true;
+}
+
+void Graph::buildGeometry(sf::Color color, float zoom) {
+    constexpr float BucketSpan = 1.0905077f; // 2^(1/8), the bucket is drawn at up to this much more zoom
+
+    // the first level that is exact for the whole zoom bucket, or the finest one
+    int level = 0;
+
+    while (level + 1 < m_Lod.LevelCount && std::ldexp(m_Lod.Zoom, level) < zoom * BucketSpan) {
+        ++level;
+    }
+
+    const std::vector<uint8_t>& levels = m_Lod.Levels;
+    const std::size_t count = m_Lod.LevelCount ? std::min(levels.size(), m_Points.size()) : 0u;
+
+    const float halfThickness = LineThickness * 0.5f / zoom;
+
+    // segments never cross a break between runs, the end of each one is kept for the reveal animation
+    std::vector<sf::Vertex> vertices;
+    m_GeometrySegmentEnds.clear();
+
+    // streams are reduced as they come in and have no levels, every point is drawn
+    if (m_Stream) {
+        vertices.reserve(m_Points.size() * 6u);
+
+        for (std::size_t i = 1u; i < m_Points.size(); ++i) {
+            if (ExtrudeSegment(m_Points[i - 1u], m_Points[i], halfThickness, zoom, color, vertices)) {
+                m_GeometrySegmentEnds.push_back(static_cast<uint32_t>(i));
+            }
+        }
+    } else {
+        // the points of the level, in order along the curve
+        const auto inLevel = [&](uint8_t pointLevel) { return pointLevel <= level; };
+        vertices.reserve(static_cast<std::size_t>(std::count_if(levels.begin(), levels.begin() + static_cast<std::ptrdiff_t>(count), inLevel)) * 6u);
+
+        std::size_t previous = count;
+
+        for (std::size_t i = 0u; i < count; ++i) {
+            if (!inLevel(levels[i])) {
+                continue;
+            }
+
+            if (previous != count && ExtrudeSegment(m_Points[previous], m_Points[i], halfThickness, zoom, color, vertices)) {
+                m_GeometrySegmentEnds.push_back(static_cast<uint32_t>(i));
+            }
+
+            previous = i;
+        }
+    }
+
+    m_GeometryPoints = m_Points.size();
+    m_GeometryZoom = zoom;
+
+    // streams keep room for a couple of windows worth of segments to append to, the rest is sized to fit
+    const std::size_t capacity = m_Stream ? std::max<std::size_t>(2u * vertices.size(), 24u * Stream::BucketsPerWindow) : vertices.size();
+
+    if (sf::VertexBuffer::isAvailable()) {
+        if (!m_Geometry) {
+            m_Geometry = std::make_unique<sf::VertexBuffer>(
+                sf::PrimitiveType::Triangles,
+                m_Stream ? sf::VertexBuffer::Usage::Stream : sf::VertexBuffer::Usage::Static
+            );
+        }
+
+        if (m_Geometry->create(capacity) && (vertices.empty() || m_Geometry->update(vertices.data(), vertices.size(), 0u))) {
+            m_FallbackGeometry.clear();
+            return;
+        }
+
+        m_Geometry.reset();
+    }
+
+    m_FallbackGeometry.resize(vertices.size());
+
+    for (std::size_t i = 0u; i < vertices.size(); ++i) {
+        m_FallbackGeometry[i] = vertices[i];
+    }
+}
+
+void Graph::appendGeometry(sf::Color color) {
+    PROFILE_SCOPE("Graph::appendGeometry");
+
+    const float halfThickness = LineThickness * 0.5f / m_GeometryZoom;
+
+    std::vector<sf::Vertex> vertices;
+    std::vector<uint32_t> ends;
+
+    for (std::size_t i = std::max<std::size_t>(m_GeometryPoints, 1u); i < m_Points.size(); ++i) {
+        if (ExtrudeSegment(m_Points[i - 1u], m_Points[i], halfThickness, m_GeometryZoom, color, vertices)) {
+            ends.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    const std::size_t offset = m_GeometrySegmentEnds.size() * 6u;
+
+    if (m_Geometry) {
+        // out of room, rebuilt with twice as much
+        if (offset + vertices.size() > m_Geometry->getVertexCount()) {
+            m_GeometryDirty = true;
+            return;
+        }
+
+        if (!vertices.empty() && !m_Geometry->update(vertices.data(), vertices.size(), static_cast<unsigned int>(offset))) {
+            m_GeometryDirty = true;
+            return;
+        }
+    } else {
+        for (const sf::Vertex& vertex : vertices) {
+            m_FallbackGeometry.append(vertex);
+        }
+    }
+
+    m_GeometrySegmentEnds.insert(m_GeometrySegmentEnds.end(), ends.begin(), ends.end());
+    m_GeometryPoints = m_Points.size();
+}
+
 void Graph::Render(sf::RenderTarget& target, sf::Color color, sf::Vector2f offset, float zoom) {
+    PROFILE_SCOPE("Graph::Render");
+
+    // quarter octave buckets keep the line within 10% of its pixel thickness
+    constexpr float BucketsPerOctave = 4.f;
+
+    // streams are never animated and draw up to their newest point
     const unsigned int numLines = static_cast<unsigned int>((m_Points.size() / 2u) * m_Progress);
 
     if (!numLines) {
         return;
     }
 
-    const unsigned int numPoints = numLines * 2u;
+    const std::size_t numPoints = m_Stream ? m_Points.size() : numLines * 2u;
 
-    const sf::Vector2u targetSize = target.getSize();
-    const sf::Vector2f center = sf::Vector2f(targetSize) * 0.5f + offset;
+    const int bucket = static_cast<int>(std::round(std::log2(zoom) * BucketsPerOctave));
+
+    if (m_GeometryDirty || bucket != m_GeometryBucket || color != m_GeometryColor) {
+        buildGeometry(color, std::exp2(static_cast<float>(bucket) / BucketsPerOctave));
+
+        m_GeometryDirty = false;
+        m_GeometryBucket = bucket;
+        m_GeometryColor = color;
+    } else if (m_Stream && m_GeometryPoints < m_Points.size()) {
+        appendGeometry(color);
 
-    constexpr float Thickness = 4.f;
+        if (m_GeometryDirty) {
+            buildGeometry(color, m_GeometryZoom);
+            m_GeometryDirty = false;
+        }
+    }
+
+    const sf::Vector2u targetSize = target.getSize();
+    sf::Vector2f center = sf::Vector2f(targetSize) * 0.5f + offset;
 
-    sf::VertexArray vertices(sf::PrimitiveType::Triangles, (numPoints - 1) * 6u);
-    unsigned int currentIndex = 0u;
+    // the origin of data points is added in pixels and in double, it can be far larger than floats resolve
+    if (m_Data) {
+        center.x = static_cast<float>(0.5 * targetSize.x + static_cast<double>(offset.x) + static_cast<double>(zoom) * m_DataOrigin);
+    }
 
-    for (unsigned int i = 0u; i + 1u < numPoints; ++i) {
-        const sf::Vector2f p0 = m_Points[i] * zoom + center;
-        const sf::Vector2f p1 = m_Points[i + 1u] * zoom + center;
+    sf::RenderStates states;
+    states.transform.translate(center).scale({zoom, zoom});
 
-        const sf::Vector2f p01 = p1 - p0;
-        const float lenSquare = p01.x * p01.x + p01.y * p01.y;
+    // the newest sample of a stream stays at x = 0 and older ones scroll off to the left
+    if (m_Stream) {
+        states.transform.translate({-static_cast<float>(m_Stream->GetLatest()), 0.f});
+    }
 
-        if (lenSquare < 1e-6f) [[unlikely]] {
-            continue;
-        }
+    // segments that end within the revealed points, past the ones a stream scrolled out of its window
+    const std::size_t numSegments = static_cast<std::size_t>(
+        std::upper_bound(m_GeometrySegmentEnds.begin(), m_GeometrySegmentEnds.end(), numPoints - 1u) - m_GeometrySegmentEnds.begin()
+    );
 
-        const sf::Vector2f dir = p01 / std::sqrt(lenSquare);
+    const std::size_t firstSegment = static_cast<std::size_t>(
+        std::upper_bound(m_GeometrySegmentEnds.begin(), m_GeometrySegmentEnds.begin() + numSegments, m_StreamFirst) - m_GeometrySegmentEnds.begin()
+    );
 
-        const sf::Vector2f normalOffset = sf::Vector2f(-dir.y, dir.x) * (Thickness * 0.5f);
+    if (firstSegment >= numSegments) {
+        return;
+    }
 
-        vertices[currentIndex++] = sf::Vertex(p0 + normalOffset, color);
-        vertices[currentIndex++] = sf::Vertex(p1 + normalOffset, color);
-        vertices[currentIndex++] = sf::Vertex(p1 - normalOffset, color);
+    const std::size_t first = firstSegment * 6u;
+    const std::size_t count = (numSegments - firstSegment) * 6u;
 
-        vertices[currentIndex++] = sf::Vertex(p0 + normalOffset, color);
-        vertices[currentIndex++] = sf::Vertex(p1 - normalOffset, color);
-        vertices[currentIndex++] = sf::Vertex(p0 - normalOffset, color);
+    if (m_Geometry) {
+        target.draw(*m_Geometry, first, count, states);
+    } else {
+        target.draw(&m_FallbackGeometry[first], count, sf::PrimitiveType::Triangles, states);
     }
+}
 
-    target.draw(vertices);
-}
\ No newline at end of file
+void Graph::RenderHeatmap(sf::RenderTarget& target, sf::Vector2f offset, float zoom) {
+    if (m_Heatmap) {
+        m_Heatmap->Render(target, offset, zoom);
+    }
+}
@@ -0,0 +1,356 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include "App/Heatmap.hpp"
+
+#include "System/Color.hpp"
+#include "System/Profiler.hpp"
+#include "System/ThreadPool.hpp"
+
+Heatmap::Heatmap(field_t field) : m_Field(std::move(field)) {}
+
+// range of the finite samples without their outermost percent on either side, so a pole or a few huge values
+// don't wash out the rest of the scale; empty (infinity, -infinity) when none is finite
+std::pair<float, float> ClippedRange(const std::vector<float>& samples) {
+    std::vector<float> finite;
+    finite.reserve(samples.size());
+
+    std::copy_if(samples.begin(), samples.end(), std::back_inserter(finite), [](float v) {
+        return std::isfinite(v);
+    });
+
+    if (finite.empty()) {
+        return {std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity()};
+    }
+
+    const std::size_t cut = finite.size() / 100u;
+
+    std::nth_element(finite.begin(), finite.begin() + static_cast<std::ptrdiff_t>(cut), finite.end());
+    const float lo = finite[cut];
+
+    std::nth_element(finite.begin(), finite.end() - 1 - static_cast<std::ptrdiff_t>(cut), finite.end());
+    const float hi = finite[finite.size() - 1u - cut];
+
+    return {lo, hi};
+}
+
+#pragma region Tiles
+
+Heatmap::TileRange Heatmap::visibleTiles(int level, sf::Vector2f offset, sf::Vector2u size, float zoom) {
+    const double extent = static_cast<double>(TileSize) * std::exp2(static_cast<double>(level));
+
+    const double left = (-0.5 * size.x - offset.x) / zoom;
+    const double right = (0.5 * size.x - offset.x) / zoom;
+    const double top = (-0.5 * size.y - offset.y) / zoom;
+    const double bottom = (0.5 * size.y - offset.y) / zoom;
+
+    return {
+        static_cast<int64_t>(std::floor(left / extent)),
+        static_cast<int64_t>(std::floor(top / extent)),
+        static_cast<int64_t>(std::floor(right / extent)),
+        static_cast<int64_t>(std::floor(bottom / extent))
+    };
+}
+
+System::Job<Heatmap::Values> Heatmap::evaluateTile(int level, int64_t tx, int64_t ty) const {
+    return System::Job<Values>::Run(
+        System::ThreadPool::Shared(),
+        [field = m_Field, level, tx, ty](const std::atomic<bool>& cancelled) -> std::optional<Values> {
+            PROFILE_SCOPE("Heatmap::evaluateTile");
+
+            // rows evaluated in one batch, cancellation is checked in between
+            constexpr unsigned int RowsPerBatch = 16u;
+            constexpr std::size_t BatchSize = static_cast<std::size_t>(RowsPerBatch) * TileSize;
+
+            const double texel = std::exp2(static_cast<double>(level));
+            const double left = static_cast<double>(tx) * TileSize * texel;
+            const double top = static_cast<double>(ty) * TileSize * texel;
+
+            std::vector<double> xs(BatchSize);
+            std::vector<double> ys(BatchSize);
+            std::vector<double> out(BatchSize);
+
+            // texel centres, the same columns for every row
+            for (std::size_t i = 0u; i < BatchSize; ++i) {
+                xs[i] = left + (static_cast<double>(i % TileSize) + 0.5) * texel;
+            }
+
+            Values values;
+            values.Samples.resize(static_cast<std::size_t>(TileSize) * TileSize);
+
+            for (unsigned int row = 0u; row < TileSize; row += RowsPerBatch) {
+                if (cancelled.load(std::memory_order_relaxed)) {
+                    return std::nullopt;
+                }
+
+                for (unsigned int r = 0u; r < RowsPerBatch; ++r) {
+                    std::fill_n(ys.begin() + static_cast<std::ptrdiff_t>(r) * TileSize, TileSize, top + (static_cast<double>(row + r) + 0.5) * texel);
+                }
+
+                field(xs.data(), ys.data(), out.data(), BatchSize);
+
+                std::transform(out.begin(), out.end(), values.Samples.begin() + static_cast<std::ptrdiff_t>(row) * TileSize, [](double v) {
+                    return static_cast<float>(v);
+                });
+            }
+
+            std::tie(values.Lo, values.Hi) = ClippedRange(values.Samples);
+
+            return values;
+        }
+    );
+}
+
+void Heatmap::uploadTile(Tile& tile) {
+    const std::vector<float>& samples = tile.Result->Samples;
+
+    const float span = m_RangeHi - m_RangeLo;
+    const float scale = span > 0.f ? 1.f / span : 0.f;
+
+    m_Pixels.resize(samples.size() * 4u);
+
+    for (std::size_t i = 0u; i < samples.size(); ++i) {
+        const float v = samples[i];
+        const sf::Color color = std::isfinite(v)
+            ? System::Color::Colormap(span > 0.f ? (v - m_RangeLo) * scale : 0.5f, Opacity)
+            : sf::Color::Transparent;
+
+        m_Pixels[i * 4u + 0u] = color.r;
+        m_Pixels[i * 4u + 1u] = color.g;
+        m_Pixels[i * 4u + 2u] = color.b;
+        m_Pixels[i * 4u + 3u] = color.a;
+    }
+
+    if (!tile.Texture) {
+        auto texture = std::make_unique<sf::Texture>();
+
+        if (!texture->resize({TileSize, TileSize})) [[unlikely]] {
+            return;
+        }
+
+        texture->setSmooth(true);
+        tile.Texture = std::move(texture);
+    }
+
+    tile.Texture->update(m_Pixels.data());
+    tile.ColorVersion = m_ColorVersion;
+}
+
+#pragma region Update
+
+void Heatmap::Update(sf::Vector2f offset, sf::Vector2u size, float zoom) {
+    PROFILE_SCOPE("Heatmap::Update");
+
+    if (zoom <= 0.f || !size.x || !size.y) {
+        return;
+    }
+
+    const bool zooming = zoom != m_LastZoom;
+    const bool moving = zooming || offset != m_LastOffset;
+
+    m_LastZoom = zoom;
+    m_LastOffset = offset;
+
+    // a texel covers one to two pixels at rest
+    m_Level = static_cast<int>(std::ceil(std::log2(1.f / zoom))) + (zooming ? CoarseLevels : 0);
+
+    const TileRange visible = visibleTiles(m_Level, offset, size, zoom);
+
+    // one tile of margin so small pans find their tiles ready
+    for (int64_t ty = visible.Top - 1; ty <= visible.Bottom + 1; ++ty) {
+        for (int64_t tx = visible.Left - 1; tx <= visible.Right + 1; ++tx) {
+            Tile& tile = m_Tiles[{m_Level, tx, ty}];
+
+            if (!tile.Result && !tile.Job.IsActive()) {
+                tile.Job = evaluateTile(m_Level, tx, ty);
+            }
+        }
+    }
+
+    for (auto& [key, tile] : m_Tiles) {
+        if (tile.Job.IsFinished()) {
+            tile.Result = tile.Job.Take();
+        }
+    }
+
+    bool complete = true;
+
+    for (int64_t ty = visible.Top; ty <= visible.Bottom && complete; ++ty) {
+        for (int64_t tx = visible.Left; tx <= visible.Right && complete; ++tx) {
+            complete = m_Tiles[{m_Level, tx, ty}].Result.has_value();
+        }
+    }
+
+    // other levels keep covering the screen until the current one is complete, dropping a pending tile cancels it
+    for (auto it = m_Tiles.begin(); it != m_Tiles.end();) {
+        const auto [level, tx, ty] = it->first;
+
+        bool keep;
+
+        if (level == m_Level) {
+            keep = tx >= visible.Left - 1 && tx <= visible.Right + 1 && ty >= visible.Top - 1 && ty <= visible.Bottom + 1;
+        } else {
+            const TileRange range = visibleTiles(level, offset, size, zoom);
+            keep = !complete && it->second.Result && tx >= range.Left && tx <= range.Right && ty >= range.Top && ty <= range.Bottom;
+        }
+
+        it = keep ? std::next(it) : m_Tiles.erase(it);
+    }
+
+    // fit the colour scale to the screen once the camera rests, or to the first tiles that arrive
+    if (moving) {
+        m_RangeFitted = false;
+    }
+
+    if (m_HasRange && (moving || !complete || m_RangeFitted)) {
+        return;
+    }
+
+    float lo = std::numeric_limits<float>::infinity();
+    float hi = -std::numeric_limits<float>::infinity();
+
+    for (int64_t ty = visible.Top; ty <= visible.Bottom; ++ty) {
+        for (int64_t tx = visible.Left; tx <= visible.Right; ++tx) {
+            if (const Tile& tile = m_Tiles[{m_Level, tx, ty}]; tile.Result) {
+                lo = std::min(lo, tile.Result->Lo);
+                hi = std::max(hi, tile.Result->Hi);
+            }
+        }
+    }
+
+    if (!(lo <= hi)) {
+        return;
+    }
+
+    m_RangeFitted = complete && !moving;
+
+    // small changes are not worth recolouring every tile for
+    const float tolerance = 0.02f * (hi - lo);
+
+    if (!m_HasRange || std::fabs(lo - m_RangeLo) > tolerance || std::fabs(hi - m_RangeHi) > tolerance) {
+        m_RangeLo = lo;
+        m_RangeHi = hi;
+        m_HasRange = true;
+        ++m_ColorVersion;
+    }
+}
+
+#pragma region Render
+
+void Heatmap::Render(sf::RenderTarget& target, sf::Vector2f offset, float zoom) {
+    PROFILE_SCOPE("Heatmap::Render");
+
+    if (!m_HasRange || zoom <= 0.f) {
+        return;
+    }
+
+    const sf::Vector2u targetSize = target.getSize();
+    const sf::Vector2f center = sf::Vector2f(targetSize) * 0.5f + offset;
+
+    unsigned int uploads = 0u;
+
+    const auto draw = [&](const key_t& key, Tile& tile) {
+        if (!tile.Result) {
+            return;
+        }
+
+        const auto [level, tx, ty] = key;
+        const TileRange visible = visibleTiles(level, offset, targetSize, zoom);
+
+        if (tx < visible.Left || tx > visible.Right || ty < visible.Top || ty > visible.Bottom) {
+            return;
+        }
+
+        // a bounded number of uploads per frame, stale tiles keep their old colours until their turn
+        if ((!tile.Texture || tile.ColorVersion != m_ColorVersion) && uploads < MaxUploadsPerFrame) {
+            uploadTile(tile);
+            ++uploads;
+        }
+
+        if (!tile.Texture) {
+            return;
+        }
+
+        const float texel = std::exp2(static_cast<float>(level));
+        const float extent = static_cast<float>(TileSize) * texel;
+
+        sf::Sprite sprite(*tile.Texture);
+        sprite.setPosition(center + sf::Vector2f(static_cast<float>(tx) * extent, static_cast<float>(ty) * extent) * zoom);
+        sprite.setScale({texel * zoom, texel * zoom});
+
+        target.draw(sprite);
+    };
+
+    // leftover levels only fill the gaps of the current one, coarsest first
+    for (auto it = m_Tiles.rbegin(); it != m_Tiles.rend(); ++it) {
+        if (std::get<0>(it->first) != m_Level) {
+            draw(it->first, it->second);
+        }
+    }
+
+    for (auto& [key, tile] : m_Tiles) {
+        if (std::get<0>(key) == m_Level) {
+            draw(key, tile);
+        }
+    }
+}
+
+#pragma region Painting
+
+void Heatmap::Paint(uint8_t* pixels, sf::Vector2u size, sf::Vector2f offset, float zoom) const {
+    PROFILE_SCOPE("Heatmap::Paint");
+
+    // rows evaluated by one task
+    constexpr std::size_t RowsPerTask = 16u;
+
+    std::vector<float> samples(static_cast<std::size_t>(size.x) * size.y);
+
+    System::ThreadPool::Shared().ParallelFor(size.y, RowsPerTask, [&](std::size_t begin, std::size_t end) {
+        std::vector<double> xs(size.x);
+        std::vector<double> ys(size.x);
+        std::vector<double> out(size.x);
+
+        // pixel centres
+        for (unsigned int column = 0u; column < size.x; ++column) {
+            xs[column] = (column + 0.5 - 0.5 * size.x - offset.x) / zoom;
+        }
+
+        for (std::size_t row = begin; row < end; ++row) {
+            std::fill(ys.begin(), ys.end(), (row + 0.5 - 0.5 * size.y - offset.y) / zoom);
+
+            m_Field(xs.data(), ys.data(), out.data(), size.x);
+
+            std::transform(out.begin(), out.end(), samples.begin() + static_cast<std::ptrdiff_t>(row * size.x), [](double v) {
+                return static_cast<float>(v);
+            });
+        }
+    });
+
+    const auto [lo, hi] = ClippedRange(samples);
+
+    if (!(lo <= hi)) {
+        return;
+    }
+
+    const float span = hi - lo;
+    const float scale = span > 0.f ? 1.f / span : 0.f;
+
+    for (std::size_t i = 0u; i < samples.size(); ++i) {
+        const float v = samples[i];
+
+        if (!std::isfinite(v)) {
+            continue;
+        }
+
+        const sf::Color color = System::Color::Colormap(span > 0.f ? (v - lo) * scale : 0.5f, Opacity);
+        const unsigned int alpha = color.a;
+
+        uint8_t* pixel = pixels + i * 4u;
+
+        pixel[0] = static_cast<uint8_t>((color.r * alpha + pixel[0] * (255u - alpha) + 127u) / 255u);
+        pixel[1] = static_cast<uint8_t>((color.g * alpha + pixel[1] * (255u - alpha) + 127u) / 255u);
+        pixel[2] = static_cast<uint8_t>((color.b * alpha + pixel[2] * (255u - alpha) + 127u) / 255u);
+    }
+}
@@ -0,0 +1,443 @@
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+#include "Math/Expression.hpp"
+#include "Math/Interval.hpp"
+
+#pragma region Arithmetic
+
+constexpr double IntervalInfinity = std::numeric_limits<double>::infinity();
+
+// one ulp outwards on both ends, libm results are not correctly rounded; a NaN end means unbounded
+Math::Interval Outward(double lo, double hi) {
+    return {
+        std::isnan(lo) ? -IntervalInfinity : std::nextafter(lo, -IntervalInfinity),
+        std::isnan(hi) ? IntervalInfinity : std::nextafter(hi, IntervalInfinity)
+    };
+}
+
+// 0 * inf is taken as 0, the bound of a product with an exact zero
+inline double MulBound(double x, double y) {
+    return (x == 0.0 || y == 0.0) ? 0.0 : x * y;
+}
+
+Math::Interval IntervalAdd(Math::Interval a, Math::Interval b) {
+    return Outward(a.Lo + b.Lo, a.Hi + b.Hi);
+}
+
+Math::Interval IntervalSub(Math::Interval a, Math::Interval b) {
+    return Outward(a.Lo - b.Hi, a.Hi - b.Lo);
+}
+
+Math::Interval IntervalNeg(Math::Interval a) {
+    return {-a.Hi, -a.Lo};
+}
+
+Math::Interval IntervalMul(Math::Interval a, Math::Interval b) {
+    const double p[] = {MulBound(a.Lo, b.Lo), MulBound(a.Lo, b.Hi), MulBound(a.Hi, b.Lo), MulBound(a.Hi, b.Hi)};
+    return Outward(*std::min_element(std::begin(p), std::end(p)), *std::max_element(std::begin(p), std::end(p)));
+}
+
+Math::Interval IntervalSqr(Math::Interval a) {
+    if (a.Contains(0.0)) {
+        return {0.0, std::nextafter(std::max(a.Lo * a.Lo, a.Hi * a.Hi), IntervalInfinity)};
+    }
+
+    const double lo = std::min(std::fabs(a.Lo), std::fabs(a.Hi));
+    const double hi = std::max(std::fabs(a.Lo), std::fabs(a.Hi));
+
+    return Outward(lo * lo, hi * hi);
+}
+
+Math::Interval IntervalDiv(Math::Interval a, Math::Interval b, bool& continuous) {
+    if (b.Contains(0.0)) {
+        continuous = false;
+        return Math::Interval::Entire();
+    }
+
+    return IntervalMul(a, Outward(1.0 / b.Hi, 1.0 / b.Lo));
+}
+
+// clips `a` to [lo, hi], the result is no longer continuous when part of `a` was outside
+Math::Interval Restrict(Math::Interval a, double lo, double hi, bool& continuous) {
+    if (a.Lo < lo || a.Hi > hi) {
+        continuous = false;
+    }
+
+    return {std::max(a.Lo, lo), std::min(a.Hi, hi)};
+}
+
+template <typename F>
+Math::Interval Increasing(F function, Math::Interval a) {
+    return Outward(function(a.Lo), function(a.Hi));
+}
+
+template <typename F>
+Math::Interval Decreasing(F function, Math::Interval a) {
+    return Outward(function(a.Hi), function(a.Lo));
+}
+
+// whether phase + k * period lies in `a` for some integer k, erring towards yes
+bool ContainsPeriodic(Math::Interval a, double phase, double period) {
+    const double slack = 1e-12 * (1.0 + std::fabs(a.Lo) + std::fabs(a.Hi));
+    const double k = std::ceil((a.Lo - slack - phase) / period);
+
+    return phase + k * period <= a.Hi + slack;
+}
+
+// sin and cos lose all precision this far out, the bounds are [-1, 1] anyway
+bool IsWideAngle(Math::Interval a) {
+    return !(a.Width() < 2.0 * std::numbers::pi) || !(std::fabs(a.Lo) < 1e9) || !(std::fabs(a.Hi) < 1e9);
+}
+
+Math::Interval IntervalSin(Math::Interval a) {
+    if (IsWideAngle(a)) {
+        return {-1.0, 1.0};
+    }
+
+    Math::Interval result = Outward(std::min(std::sin(a.Lo), std::sin(a.Hi)), std::max(std::sin(a.Lo), std::sin(a.Hi)));
+
+    if (ContainsPeriodic(a, 0.5 * std::numbers::pi, 2.0 * std::numbers::pi)) {
+        result.Hi = 1.0;
+    }
+
+    if (ContainsPeriodic(a, -0.5 * std::numbers::pi, 2.0 * std::numbers::pi)) {
+        result.Lo = -1.0;
+    }
+
+    return {std::max(result.Lo, -1.0), std::min(result.Hi, 1.0)};
+}
+
+Math::Interval IntervalCos(Math::Interval a) {
+    if (IsWideAngle(a)) {
+        return {-1.0, 1.0};
+    }
+
+    Math::Interval result = Outward(std::min(std::cos(a.Lo), std::cos(a.Hi)), std::max(std::cos(a.Lo), std::cos(a.Hi)));
+
+    if (ContainsPeriodic(a, 0.0, 2.0 * std::numbers::pi)) {
+        result.Hi = 1.0;
+    }
+
+    if (ContainsPeriodic(a, std::numbers::pi, 2.0 * std::numbers::pi)) {
+        result.Lo = -1.0;
+    }
+
+    return {std::max(result.Lo, -1.0), std::min(result.Hi, 1.0)};
+}
+
+Math::Interval IntervalTan(Math::Interval a, bool& continuous) {
+    if (!(a.Width() < std::numbers::pi) || !(std::fabs(a.Lo) < 1e9) || !(std::fabs(a.Hi) < 1e9) || ContainsPeriodic(a, 0.5 * std::numbers::pi, std::numbers::pi)) {
+        continuous = false;
+        return Math::Interval::Entire();
+    }
+
+    return Increasing([](double x) { return std::tan(x); }, a);
+}
+
+Math::Interval IntervalCosh(Math::Interval a) {
+    if (a.Contains(0.0)) {
+        return Outward(1.0, std::max(std::cosh(a.Lo), std::cosh(a.Hi)));
+    }
+
+    return a.Lo > 0.0
+        ? Increasing([](double x) { return std::cosh(x); }, a)
+        : Decreasing([](double x) { return std::cosh(x); }, a);
+}
+
+Math::Interval IntervalExp(Math::Interval a) {
+    return Increasing([](double x) { return std::exp(x); }, a);
+}
+
+// log(0) is -inf, which the graphs treat as undefined just like negative inputs
+Math::Interval IntervalLog(Math::Interval a, bool& continuous) {
+    if (!(a.Hi > 0.0)) {
+        return Math::Interval::Empty();
+    }
+
+    if (!(a.Lo > 0.0)) {
+        continuous = false;
+        return Outward(-IntervalInfinity, std::log(a.Hi));
+    }
+
+    return Increasing([](double x) { return std::log(x); }, a);
+}
+
+Math::Interval IntervalPow(Math::Interval a, Math::Interval b, bool& continuous) {
+    if (b.Lo != b.Hi) {
+        // exp(b * ln(a)) is only well behaved for a positive base
+        if (!(a.Lo > 0.0)) {
+            continuous = false;
+            return Math::Interval::Entire();
+        }
+
+        return IntervalExp(IntervalMul(b, IntervalLog(a, continuous)));
+    }
+
+    const double n = b.Lo;
+
+    if (n == std::floor(n) && std::fabs(n) < 9007199254740992.0) {
+        if (n == 0.0) {
+            return Math::Interval::Point(1.0);
+        }
+
+        const bool even = std::fmod(n, 2.0) == 0.0;
+
+        if (n < 0.0 && a.Contains(0.0)) {
+            continuous = false;
+            return even ? Outward(std::pow(std::max(std::fabs(a.Lo), std::fabs(a.Hi)), n), IntervalInfinity) : Math::Interval::Entire();
+        }
+
+        if (even) {
+            // a function of |a|, growing for positive powers
+            const double closest = a.Contains(0.0) ? 0.0 : std::min(std::fabs(a.Lo), std::fabs(a.Hi));
+            const double farthest = std::max(std::fabs(a.Lo), std::fabs(a.Hi));
+
+            return n > 0.0 ? Outward(std::pow(closest, n), std::pow(farthest, n)) : Outward(std::pow(farthest, n), std::pow(closest, n));
+        }
+
+        return n > 0.0 ? Increasing([n](double x) { return std::pow(x, n); }, a) : Decreasing([n](double x) { return std::pow(x, n); }, a);
+    }
+
+    // a fractional power is undefined below zero and has a pole at zero when negative
+    if (!(a.Hi >= 0.0)) {
+        return Math::Interval::Empty();
+    }
+
+    a = Restrict(a, 0.0, IntervalInfinity, continuous);
+
+    if (n > 0.0) {
+        return Increasing([n](double x) { return std::pow(x, n); }, a);
+    }
+
+    if (a.Lo == 0.0) {
+        continuous = false;
+    }
+
+    return Decreasing([n](double x) { return std::pow(x, n); }, a);
+}
+
+// atan2(y, x) takes its extremes on the corners of any box that keeps clear of the cut along the negative x axis
+Math::Interval IntervalAtan2(Math::Interval y, Math::Interval x, bool& continuous) {
+    if (y.Contains(0.0) && x.Lo <= 0.0) {
+        continuous = false;
+        return Outward(-std::numbers::pi, std::numbers::pi);
+    }
+
+    const double corners[] = {std::atan2(y.Lo, x.Lo), std::atan2(y.Lo, x.Hi), std::atan2(y.Hi, x.Lo), std::atan2(y.Hi, x.Hi)};
+    return Outward(*std::min_element(std::begin(corners), std::end(corners)), *std::max_element(std::begin(corners), std::end(corners)));
+}
+
+// fmod keeps the sign of the dividend, it only stays continuous while a / b does not cross an integer
+Math::Interval IntervalMod(Math::Interval a, Math::Interval b, bool& continuous) {
+    const double q = std::max(std::fabs(b.Lo), std::fabs(b.Hi));
+
+    if (b.Lo != b.Hi || b.Lo == 0.0) {
+        continuous = false;
+        return b.Lo == b.Hi ? Math::Interval::Empty() : Math::Interval{-q, q};
+    }
+
+    if (-q < a.Lo && a.Hi < q) {
+        return a;
+    }
+
+    if (a.Lo >= 0.0 && std::floor(a.Lo / q) == std::floor(a.Hi / q)) {
+        const double k = std::floor(a.Lo / q) * q;
+        return Outward(a.Lo - k, a.Hi - k);
+    }
+
+    if (a.Hi <= 0.0 && std::ceil(a.Lo / q) == std::ceil(a.Hi / q)) {
+        const double k = std::ceil(a.Hi / q) * q;
+        return Outward(a.Lo - k, a.Hi - k);
+    }
+
+    continuous = false;
+    return {a.Lo < 0.0 ? -q : 0.0, a.Hi > 0.0 ? q : 0.0};
+}
+
+#pragma region Operations
+
+Math::IntervalValue Math::Apply(OpCode op, const IntervalValue& a, const IntervalValue& b) {
+    constexpr IntervalValue Undefined = {Interval::Empty(), Interval::Entire(), false};
+
+    if (a.Value.IsEmpty() || (IsBinary(op) && b.Value.IsEmpty())) {
+        return Undefined;
+    }
+
+    bool continuous = a.Continuous && (!IsBinary(op) || b.Continuous);
+
+    const Interval x = a.Value;
+    const Interval y = b.Value;
+    const Interval dx = a.Slope;
+    const Interval dy = b.Slope;
+
+    Interval value = Interval::Entire();
+    Interval slope = Interval::Point(0.0);
+
+    // slopes that divide by something containing zero come out unbounded, which is still correct
+    bool ignored = true;
+
+    switch (op) {
+        case OpCode::Add:
+            value = IntervalAdd(x, y);
+            slope = IntervalAdd(dx, dy);
+            break;
+        case OpCode::Sub:
+            value = IntervalSub(x, y);
+            slope = IntervalSub(dx, dy);
+            break;
+        case OpCode::Mul:
+            value = IntervalMul(x, y);
+            slope = IntervalAdd(IntervalMul(dx, y), IntervalMul(x, dy));
+            break;
+        case OpCode::Div:
+            value = IntervalDiv(x, y, continuous);
+            slope = IntervalDiv(IntervalSub(IntervalMul(dx, y), IntervalMul(x, dy)), IntervalSqr(y), ignored);
+            break;
+        case OpCode::Mod:
+            value = IntervalMod(x, y, continuous);
+            slope = dx;
+            break;
+        case OpCode::Pow:
+            value = IntervalPow(x, y, continuous);
+
+            if (y.Lo == y.Hi) {
+                slope = IntervalMul(IntervalMul(Interval::Point(y.Lo), IntervalPow(x, Interval::Point(y.Lo - 1.0), ignored)), dx);
+            } else {
+                slope = IntervalMul(value, IntervalAdd(IntervalMul(dy, IntervalLog(x, ignored)), IntervalDiv(IntervalMul(y, dx), x, ignored)));
+            }
+            break;
+        case OpCode::Atan2:
+            value = IntervalAtan2(x, y, continuous);
+            slope = IntervalDiv(IntervalSub(IntervalMul(y, dx), IntervalMul(x, dy)), IntervalAdd(IntervalSqr(x), IntervalSqr(y)), ignored);
+            break;
+        case OpCode::Ncr:
+        case OpCode::Npr:
+            if (x.Lo == x.Hi && y.Lo == y.Hi) {
+                const double result = Math::Apply(op, x.Lo, y.Lo);
+
+                if (std::isnan(result)) {
+                    return Undefined;
+                }
+
+                value = Interval::Point(result);
+            } else {
+                continuous = false;
+                value = {0.0, IntervalInfinity};
+            }
+            break;
+        case OpCode::Neg:
+            value = IntervalNeg(x);
+            slope = IntervalNeg(dx);
+            break;
+        case OpCode::Abs:
+            if (x.Lo >= 0.0) {
+                value = x;
+                slope = dx;
+            } else if (x.Hi <= 0.0) {
+                value = IntervalNeg(x);
+                slope = IntervalNeg(dx);
+            } else {
+                value = {0.0, std::max(-x.Lo, x.Hi)};
+                slope = IntervalMul({-1.0, 1.0}, dx);
+            }
+            break;
+        case OpCode::Acos:
+        case OpCode::Asin: {
+            const Interval clipped = Restrict(x, -1.0, 1.0, continuous);
+
+            if (clipped.IsEmpty()) {
+                return Undefined;
+            }
+
+            const auto function = [op](double v) { return op == OpCode::Acos ? std::acos(v) : std::asin(v); };
+            value = op == OpCode::Acos ? Decreasing(function, clipped) : Increasing(function, clipped);
+
+            const Interval root = Increasing([](double v) { return std::sqrt(std::max(v, 0.0)); }, IntervalSub(Interval::Point(1.0), IntervalSqr(clipped)));
+            slope = IntervalDiv(op == OpCode::Acos ? IntervalNeg(dx) : dx, root, ignored);
+            break;
+        }
+        case OpCode::Atan:
+            value = Increasing([](double v) { return std::atan(v); }, x);
+            slope = IntervalDiv(dx, IntervalAdd(Interval::Point(1.0), IntervalSqr(x)), ignored);
+            break;
+        case OpCode::Ceil:
+        case OpCode::Floor: {
+            const auto function = [op](double v) { return op == OpCode::Ceil ? std::ceil(v) : std::floor(v); };
+            value = {function(x.Lo), function(x.Hi)};
+            continuous = continuous && value.Lo == value.Hi;
+            break;
+        }
+        case OpCode::Cos:
+            value = IntervalCos(x);
+            slope = IntervalMul(IntervalNeg(IntervalSin(x)), dx);
+            break;
+        case OpCode::Cosh:
+            value = IntervalCosh(x);
+            slope = IntervalMul(Increasing([](double v) { return std::sinh(v); }, x), dx);
+            break;
+        case OpCode::Exp:
+            value = IntervalExp(x);
+            slope = IntervalMul(value, dx);
+            break;
+        case OpCode::Fac: {
+            // a step function of the truncated argument, NaN below zero
+            const Interval clipped = Restrict(x, 0.0, IntervalInfinity, continuous);
+
+            if (clipped.IsEmpty()) {
+                return Undefined;
+            }
+
+            value = {Math::Apply(op, clipped.Lo), Math::Apply(op, clipped.Hi)};
+            continuous = continuous && std::trunc(clipped.Lo) == std::trunc(clipped.Hi);
+            break;
+        }
+        case OpCode::Ln:
+        case OpCode::Log10: {
+            const double scale = op == OpCode::Ln ? 1.0 : std::numbers::ln10;
+            value = IntervalLog(x, continuous);
+
+            if (op == OpCode::Log10 && !value.IsEmpty()) {
+                value = Outward(value.Lo / scale, value.Hi / scale);
+            }
+
+            slope = IntervalDiv(dx, IntervalMul(x, Interval::Point(scale)), ignored);
+            break;
+        }
+        case OpCode::Sin:
+            value = IntervalSin(x);
+            slope = IntervalMul(IntervalCos(x), dx);
+            break;
+        case OpCode::Sinh:
+            value = Increasing([](double v) { return std::sinh(v); }, x);
+            slope = IntervalMul(IntervalCosh(x), dx);
+            break;
+        case OpCode::Sqrt: {
+            const Interval clipped = Restrict(x, 0.0, IntervalInfinity, continuous);
+
+            if (clipped.IsEmpty()) {
+                return Undefined;
+            }
+
+            value = Increasing([](double v) { return std::sqrt(v); }, clipped);
+            value.Lo = std::max(value.Lo, 0.0);
+            slope = IntervalDiv(dx, IntervalMul(Interval::Point(2.0), value), ignored);
+            break;
+        }
+        case OpCode::Tan:
+            value = IntervalTan(x, continuous);
+            slope = IntervalMul(IntervalAdd(Interval::Point(1.0), IntervalSqr(value)), dx);
+            break;
+        case OpCode::Tanh:
+            value = Increasing([](double v) { return std::tanh(v); }, x);
+            slope = IntervalMul(IntervalSub(Interval::Point(1.0), IntervalSqr(value)), dx);
+            break;
+    }
+
+    if (value.IsEmpty()) {
+        return Undefined;
+    }
+
+    return {value, continuous ? slope : Interval::Entire(), continuous};
+}
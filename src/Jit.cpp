@@ -0,0 +1,488 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <unordered_map>
+
+#include "Math/Jit.hpp"
+
+#if defined(__x86_64__) && (defined(__unix__) || defined(__APPLE__))
+    #define GRAPH_JIT_X86_64_SYSV
+
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+using Math::OpCode;
+
+#pragma region Program
+
+Math::Jit::Program::Program(void* memory, std::size_t size, std::size_t entryOffset) noexcept
+    : m_Memory(memory), m_Size(size), m_Entry(reinterpret_cast<entry_t>(static_cast<uint8_t*>(memory) + entryOffset)) {}
+
+Math::Jit::Program::~Program() {
+#ifdef GRAPH_JIT_X86_64_SYSV
+    munmap(m_Memory, m_Size);
+#endif
+}
+
+std::atomic<bool>& JitEnabled() {
+    static std::atomic<bool> enabled{false};
+    return enabled;
+}
+
+bool Math::Jit::IsAvailable() noexcept {
+#ifdef GRAPH_JIT_X86_64_SYSV
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool Math::Jit::IsEnabled() noexcept {
+    return JitEnabled().load(std::memory_order_relaxed);
+}
+
+void Math::Jit::SetEnabled(bool enabled) noexcept {
+    JitEnabled().store(enabled && IsAvailable(), std::memory_order_relaxed);
+}
+
+#ifdef GRAPH_JIT_X86_64_SYSV
+
+#pragma region Assembler
+
+// 32 bytes of each mask at the start of the program, the code follows
+constexpr std::size_t SignMaskOffset = 0u;
+constexpr std::size_t AbsMaskOffset = 32u;
+constexpr std::size_t CodeOffset = 64u;
+
+constexpr int VectorRegisterCount = 16;
+
+// the handful of x86-64 encodings the generator needs; vector operands are xmm with SSE2 and ymm with AVX
+class JitAssembler {
+public:
+    // a vector register, a register row at the current lane offset [rbx + r13 + disp], or a mask in the data block
+    struct Operand {
+        enum class Kind : uint8_t {
+            Register,
+            Row,
+            Data
+        };
+
+        Kind Type;
+        int32_t Value;
+    };
+
+    static constexpr Operand Register(int r) { return {Operand::Kind::Register, r}; }
+    static constexpr Operand Row(int32_t offset) { return {Operand::Kind::Row, offset}; }
+    static constexpr Operand Data(int32_t offset) { return {Operand::Kind::Data, offset}; }
+
+    enum VectorOp : uint8_t {
+        LoadOp = 0x10,
+        StoreOp = 0x11,
+        MoveOp = 0x28,
+        SqrtOp = 0x51,
+        AndOp = 0x54,
+        XorOp = 0x57,
+        AddOp = 0x58,
+        MulOp = 0x59,
+        SubOp = 0x5C,
+        DivOp = 0x5E
+    };
+
+private:
+    void bytes(std::initializer_list<uint8_t> values) {
+        Code.insert(Code.end(), values);
+    }
+
+    void dword(uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            Code.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    void modrm(int reg, Operand rm) {
+        switch (rm.Type) {
+            case Operand::Kind::Register:
+                Code.push_back(static_cast<uint8_t>(0xC0 | (reg & 7) << 3 | (rm.Value & 7)));
+                break;
+            case Operand::Kind::Row:
+                // mod 10 with a SIB byte: base rbx, index r13, scale 1, disp32
+                Code.push_back(static_cast<uint8_t>(0x84 | (reg & 7) << 3));
+                Code.push_back(0x2B);
+                dword(static_cast<uint32_t>(rm.Value));
+                break;
+            case Operand::Kind::Data: {
+                // rip relative, the displacement counts from the end of the instruction which ends with it
+                Code.push_back(static_cast<uint8_t>(0x05 | (reg & 7) << 3));
+                const int64_t next = static_cast<int64_t>(m_Base + Code.size() + 4u);
+                dword(static_cast<uint32_t>(static_cast<int32_t>(rm.Value - next)));
+                break;
+            }
+        }
+    }
+
+    void encode(uint8_t op, int reg, int source, Operand rm) {
+        const bool r = reg >= 8;
+        const bool x = rm.Type == Operand::Kind::Row; // r13 as the index
+        const bool b = rm.Type == Operand::Kind::Register && rm.Value >= 8;
+
+        if (Avx) {
+            // three byte VEX, map 0F, 256 bit, 66 prefix; source is the extra register operand, 0 when unused
+            Code.push_back(0xC4);
+            Code.push_back(static_cast<uint8_t>((!r) << 7 | (!x) << 6 | (!b) << 5 | 0x01));
+            Code.push_back(static_cast<uint8_t>((~source & 0xF) << 3 | 0x04 | 0x01));
+        } else {
+            Code.push_back(0x66);
+
+            if (r || x || b) {
+                Code.push_back(static_cast<uint8_t>(0x40 | r << 2 | x << 1 | b));
+            }
+
+            Code.push_back(0x0F);
+        }
+
+        Code.push_back(op);
+        modrm(reg, rm);
+    }
+
+    std::size_t m_Base;
+
+public:
+    JitAssembler(bool avx, std::size_t base) : m_Base(base), Avx(avx) {}
+
+    void Load(int dst, Operand source) {
+        encode(LoadOp, dst, 0, source);
+    }
+
+    void Store(Operand dst, int source) {
+        encode(StoreOp, source, 0, dst);
+    }
+
+    // dst = a op b, SSE2 copies a into dst first, so dst must not be b unless it is also a
+    void Binary(VectorOp op, int dst, int a, Operand b) {
+        if (Avx) {
+            encode(op, dst, a, b);
+            return;
+        }
+
+        if (dst != a) {
+            encode(MoveOp, dst, 0, Register(a));
+        }
+
+        encode(op, dst, 0, b);
+    }
+
+    void Sqrt(int dst, int a) {
+        encode(SqrtOp, dst, 0, Register(a));
+    }
+
+    void Prologue() {
+        bytes({0x53, 0x41, 0x54, 0x41, 0x55, 0x41, 0x56, 0x41, 0x57}); // push rbx, r12, r13, r14, r15
+        bytes({0x48, 0x89, 0xFB});                                     // mov rbx, rdi (rows)
+        bytes({0x49, 0x89, 0xF4});                                     // mov r12, rsi (padded)
+        bytes({0x49, 0x89, 0xF6, 0x49, 0xC1, 0xE6, 0x03});             // r14 = padded * 8
+    }
+
+    void Epilogue() {
+        if (Avx) {
+            bytes({0xC5, 0xF8, 0x77}); // vzeroupper
+        }
+
+        bytes({0x41, 0x5F, 0x41, 0x5E, 0x41, 0x5D, 0x41, 0x5C, 0x5B, 0xC3});
+    }
+
+    // r13 walks the lanes in bytes
+    std::size_t LoopBegin() {
+        bytes({0x45, 0x31, 0xED}); // xor r13d, r13d
+        return Code.size();
+    }
+
+    void LoopEnd(std::size_t top, uint8_t step) {
+        bytes({0x49, 0x83, 0xC5, step}); // add r13, step
+        bytes({0x4D, 0x39, 0xF5});       // cmp r13, r14
+        bytes({0x0F, 0x82});             // jb top
+        dword(static_cast<uint32_t>(static_cast<int32_t>(top) - static_cast<int32_t>(Code.size() + 4u)));
+    }
+
+    // kernel(rows + dst, rows + a, rows + b, padded), the rows are byte offsets from rbx
+    void CallKernel(Math::Simd::kernel_t kernel, int32_t dst, int32_t a, int32_t b) {
+        if (Avx) {
+            bytes({0xC5, 0xF8, 0x77}); // vzeroupper, the kernels may use legacy SSE encodings
+        }
+
+        bytes({0x48, 0x8D, 0xBB});
+        dword(static_cast<uint32_t>(dst)); // lea rdi, [rbx + dst]
+        bytes({0x48, 0x8D, 0xB3});
+        dword(static_cast<uint32_t>(a));   // lea rsi, [rbx + a]
+        bytes({0x48, 0x8D, 0x93});
+        dword(static_cast<uint32_t>(b));   // lea rdx, [rbx + b]
+        bytes({0x4C, 0x89, 0xE1});         // mov rcx, r12
+
+        bytes({0x48, 0xB8});               // mov rax, kernel
+        const uint64_t address = reinterpret_cast<uint64_t>(kernel);
+        dword(static_cast<uint32_t>(address));
+        dword(static_cast<uint32_t>(address >> 32u));
+
+        bytes({0xFF, 0xD0});               // call rax
+    }
+
+    std::vector<uint8_t> Code;
+    const bool Avx;
+};
+
+#pragma region Code Generation
+
+inline bool IsInlined(OpCode op) {
+    switch (op) {
+        case OpCode::Add:
+        case OpCode::Sub:
+        case OpCode::Mul:
+        case OpCode::Div:
+        case OpCode::Neg:
+        case OpCode::Abs:
+        case OpCode::Sqrt:
+            return true;
+        default:
+            return false;
+    }
+}
+
+class JitGenerator {
+private:
+    [[nodiscard]] bool reads(const Math::Instruction& instruction, uint16_t r) const {
+        return instruction.A == r || (Math::IsBinary(instruction.Op) && instruction.B == r);
+    }
+
+    // whether r is read in [from, to) before it is written again
+    [[nodiscard]] bool readBeforeWrite(uint16_t r, std::size_t from, std::size_t to) const {
+        for (std::size_t k = from; k < to; ++k) {
+            if (reads(m_Code[k], r)) {
+                return true;
+            }
+
+            if (m_Code[k].Dst == r) {
+                return false;
+            }
+        }
+
+        return false;
+    }
+
+    [[nodiscard]] bool writtenIn(uint16_t r, std::size_t from, std::size_t to) const {
+        for (std::size_t k = from; k < to; ++k) {
+            if (m_Code[k].Dst == r) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // the row has to hold the value once the fused loop is done
+    [[nodiscard]] bool storeNeeded(std::size_t k, std::size_t end) const {
+        const uint16_t r = m_Code[k].Dst;
+
+        if (writtenIn(r, k + 1u, end)) {
+            return false;
+        }
+
+        if (readBeforeWrite(r, end, m_Code.size())) {
+            return true;
+        }
+
+        return std::find(m_Results.begin(), m_Results.end(), r) != m_Results.end() && !writtenIn(r, end, m_Code.size());
+    }
+
+    [[nodiscard]] int32_t row(uint16_t r) const {
+        return static_cast<int32_t>(r * m_RowBytes);
+    }
+
+    // one lane loop over [begin, end), returns where it ran out of vector registers, end when everything fit
+    std::size_t fuse(std::size_t begin, std::size_t end, JitAssembler& assembler) const {
+        std::unordered_map<uint16_t, int> values;
+        bool used[VectorRegisterCount] = {};
+
+        const auto allocate = [&]() {
+            for (int v = 0; v < VectorRegisterCount; ++v) {
+                if (!used[v]) {
+                    used[v] = true;
+                    return v;
+                }
+            }
+
+            return -1;
+        };
+
+        const auto release = [&](uint16_t r) {
+            if (const auto it = values.find(r); it != values.end()) {
+                used[it->second] = false;
+                values.erase(it);
+            }
+        };
+
+        const auto operand = [&](uint16_t r) {
+            if (const auto it = values.find(r); it != values.end()) {
+                return it->second;
+            }
+
+            const int v = allocate();
+
+            if (v >= 0) {
+                assembler.Load(v, JitAssembler::Row(row(r)));
+                values[r] = v;
+            }
+
+            return v;
+        };
+
+        const std::size_t top = assembler.LoopBegin();
+
+        for (std::size_t k = begin; k < end; ++k) {
+            const Math::Instruction& instruction = m_Code[k];
+            const bool binary = Math::IsBinary(instruction.Op);
+
+            const int a = operand(instruction.A);
+            const int b = binary && a >= 0 ? operand(instruction.B) : 0;
+            const int dst = a >= 0 && b >= 0 ? allocate() : -1;
+
+            if (dst < 0) {
+                return k;
+            }
+
+            switch (instruction.Op) {
+                case OpCode::Add: assembler.Binary(JitAssembler::AddOp, dst, a, JitAssembler::Register(b)); break;
+                case OpCode::Sub: assembler.Binary(JitAssembler::SubOp, dst, a, JitAssembler::Register(b)); break;
+                case OpCode::Mul: assembler.Binary(JitAssembler::MulOp, dst, a, JitAssembler::Register(b)); break;
+                case OpCode::Div: assembler.Binary(JitAssembler::DivOp, dst, a, JitAssembler::Register(b)); break;
+                case OpCode::Neg: assembler.Binary(JitAssembler::XorOp, dst, a, JitAssembler::Data(SignMaskOffset)); break;
+                case OpCode::Abs: assembler.Binary(JitAssembler::AndOp, dst, a, JitAssembler::Data(AbsMaskOffset)); break;
+                case OpCode::Sqrt: assembler.Sqrt(dst, a); break;
+                default: break;
+            }
+
+            // operands nobody in the loop reads again, the destination row's old value is replaced below
+            for (const uint16_t r : {instruction.A, binary ? instruction.B : instruction.A}) {
+                if (r != instruction.Dst && !readBeforeWrite(r, k + 1u, end)) {
+                    release(r);
+                }
+            }
+
+            release(instruction.Dst);
+            values[instruction.Dst] = dst;
+
+            if (storeNeeded(k, end)) {
+                assembler.Store(JitAssembler::Row(row(instruction.Dst)), dst);
+            }
+
+            if (!readBeforeWrite(instruction.Dst, k + 1u, end)) {
+                release(instruction.Dst);
+            }
+        }
+
+        assembler.LoopEnd(top, static_cast<uint8_t>(m_Width * sizeof(double)));
+        return end;
+    }
+
+    const std::vector<Math::Instruction>& m_Code;
+    const std::vector<uint16_t>& m_Results;
+    std::size_t m_RowBytes;
+    std::size_t m_Width;
+    bool m_Avx;
+
+public:
+    JitGenerator(const std::vector<Math::Instruction>& code, const std::vector<uint16_t>& results, std::size_t batchSize, bool avx)
+        : m_Code(code), m_Results(results), m_RowBytes(batchSize * sizeof(double)), m_Width(avx ? 4u : 2u), m_Avx(avx) {}
+
+    std::vector<uint8_t> Generate() const {
+        JitAssembler assembler(m_Avx, CodeOffset);
+        assembler.Prologue();
+
+        std::size_t k = 0u;
+
+        while (k < m_Code.size()) {
+            const Math::Instruction& instruction = m_Code[k];
+
+            if (!IsInlined(instruction.Op)) {
+                assembler.CallKernel(Math::Simd::GetKernel(instruction.Op), row(instruction.Dst), row(instruction.A), row(instruction.B));
+                ++k;
+                continue;
+            }
+
+            std::size_t end = k;
+
+            while (end < m_Code.size() && IsInlined(m_Code[end].Op)) {
+                ++end;
+            }
+
+            // shorter loops free their registers sooner, so shrinking to where registers ran out always fits
+            while (true) {
+                JitAssembler loop(m_Avx, CodeOffset + assembler.Code.size());
+                const std::size_t fitted = fuse(k, end, loop);
+
+                if (fitted == end) {
+                    assembler.Code.insert(assembler.Code.end(), loop.Code.begin(), loop.Code.end());
+                    break;
+                }
+
+                end = fitted;
+            }
+
+            k = end;
+        }
+
+        assembler.Epilogue();
+        return std::move(assembler.Code);
+    }
+};
+
+#endif
+
+std::shared_ptr<const Math::Jit::Program> Math::Jit::Compile(const std::vector<Instruction>& code, const std::vector<uint16_t>& results, std::size_t batchSize, Simd::Isa isa) {
+#ifdef GRAPH_JIT_X86_64_SYSV
+    // row offsets are encoded as 32 bit displacements
+    constexpr std::size_t MaxRowBytes = INT32_MAX;
+
+    if (isa == Simd::Isa::Scalar || (static_cast<std::size_t>(UINT16_MAX) + 1u) * batchSize * sizeof(double) > MaxRowBytes) {
+        return nullptr;
+    }
+
+    const std::vector<uint8_t> text = JitGenerator(code, results, batchSize, isa == Simd::Isa::Avx2).Generate();
+
+    const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    const std::size_t size = (CodeOffset + text.size() + page - 1u) / page * page;
+
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (memory == MAP_FAILED) {
+        return nullptr;
+    }
+
+    uint8_t* bytes = static_cast<uint8_t*>(memory);
+
+    for (std::size_t i = 0u; i < 4u; ++i) {
+        constexpr uint64_t Sign = 0x8000000000000000u;
+
+        std::memcpy(bytes + SignMaskOffset + i * sizeof(uint64_t), &Sign, sizeof(uint64_t));
+
+        const uint64_t magnitude = ~Sign;
+        std::memcpy(bytes + AbsMaskOffset + i * sizeof(uint64_t), &magnitude, sizeof(uint64_t));
+    }
+
+    std::memcpy(bytes + CodeOffset, text.data(), text.size());
+
+    // never writable and executable at the same time
+    if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, size);
+        return nullptr;
+    }
+
+    return std::make_shared<const Program>(memory, size, CodeOffset);
+#else
+    (void)code;
+    (void)results;
+    (void)batchSize;
+    (void)isa;
+
+    return nullptr;
+#endif
+}
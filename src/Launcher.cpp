@@ -1,5 +1,7 @@
 #include "System/Launcher.hpp"
 
+#include "System/Profiler.hpp"
+
 Launcher::Launcher(Config&& config) : m_Config(std::move(config)) {
     // size in case the window begin with fullscreen mode
     // in that case program has no idea about the state before fullscreen
@@ -13,6 +15,8 @@ Launcher::Launcher(Config&& config) : m_Config(std::move(config)) {
 }
 
 void Launcher::Update() {
+    PROFILE_SCOPE("Launcher::Update");
+
     static sf::Clock deltaClock;
 
     const float deltaTime = deltaClock.restart().asSeconds();
@@ -32,6 +36,8 @@ void Launcher::processApplicationSignal(Application::SignalType signal) {
 }
 
 void Launcher::Render() {
+    PROFILE_SCOPE("Launcher::Render");
+
     m_Window.clear();
 
     m_Application.Render(m_Window);
@@ -40,6 +46,8 @@ void Launcher::Render() {
 }
 
 void Launcher::HandleEvents() {
+    PROFILE_SCOPE("Launcher::HandleEvents");
+
     while (const std::optional<sf::Event> event = m_Window.pollEvent()) {
         onEvent(event.value());
     }
@@ -54,6 +62,18 @@ bool Launcher::LoadResources(const char* root) {
         return false;
     }
 
+    if (m_Config.SessionPath) {
+        m_Application.OpenSession(m_Config.SessionPath);
+    }
+
+    for (const std::string& path : m_Config.DataPaths) {
+        m_Application.AddDataSeries(path);
+    }
+
+    if (m_Config.StreamPath) {
+        m_Application.AddStream(m_Config.StreamPath, m_Config.StreamWindow, m_Config.StreamDrop ? Stream::Overflow::Drop : Stream::Overflow::Block);
+    }
+
     return true;
 }
 
@@ -111,6 +131,12 @@ void Launcher::onEvent(const sf::Event& event) {
             toggleFullscreen();
         }
 
+#ifdef GRAPH_PLOTTER_PROFILE
+        else if (key->scancode == sf::Keyboard::Scancode::F12) {
+            PROFILE_WRITE("trace.json");
+        }
+#endif
+
         else {
             m_Application.HandleKeyPress(key->scancode);
         }
@@ -0,0 +1,136 @@
+#include <utility>
+
+#include "System/MappedFile.hpp"
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+System::MappedFile::~MappedFile() {
+    close();
+}
+
+System::MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+System::MappedFile& System::MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+
+        m_Data = std::exchange(other.m_Data, nullptr);
+        m_Size = std::exchange(other.m_Size, 0u);
+
+#ifdef _WIN32
+        m_File = std::exchange(other.m_File, nullptr);
+        m_Mapping = std::exchange(other.m_Mapping, nullptr);
+#endif
+    }
+
+    return *this;
+}
+
+void System::MappedFile::close() noexcept {
+#ifdef _WIN32
+    if (m_Data) {
+        UnmapViewOfFile(m_Data);
+    }
+
+    if (m_Mapping) {
+        CloseHandle(m_Mapping);
+    }
+
+    if (m_File) {
+        CloseHandle(m_File);
+    }
+
+    m_File = nullptr;
+    m_Mapping = nullptr;
+#else
+    if (m_Data) {
+        munmap(const_cast<uint8_t*>(m_Data), m_Size);
+    }
+#endif
+
+    m_Data = nullptr;
+    m_Size = 0u;
+}
+
+System::Error::ResultWrapper<System::MappedFile> System::MappedFile::Open(const std::string& path) {
+    MappedFile file;
+
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (handle == INVALID_HANDLE_VALUE) {
+        return Error::failure<MappedFile>("Couldn't open " + path);
+    }
+
+    file.m_File = handle;
+
+    LARGE_INTEGER size;
+
+    if (!GetFileSizeEx(handle, &size)) {
+        return Error::failure<MappedFile>("Couldn't read the size of " + path);
+    }
+
+    if (size.QuadPart == 0) {
+        return Error::success(std::move(file));
+    }
+
+    file.m_Mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (!file.m_Mapping) {
+        return Error::failure<MappedFile>("Couldn't map " + path);
+    }
+
+    file.m_Data = static_cast<const uint8_t*>(MapViewOfFile(file.m_Mapping, FILE_MAP_READ, 0, 0, 0));
+
+    if (!file.m_Data) {
+        return Error::failure<MappedFile>("Couldn't map " + path);
+    }
+
+    file.m_Size = static_cast<std::size_t>(size.QuadPart);
+#else
+    const int descriptor = open(path.c_str(), O_RDONLY);
+
+    if (descriptor < 0) {
+        return Error::failure<MappedFile>("Couldn't open " + path);
+    }
+
+    struct stat status;
+
+    if (fstat(descriptor, &status) != 0) {
+        ::close(descriptor);
+        return Error::failure<MappedFile>("Couldn't read the size of " + path);
+    }
+
+    if (status.st_size == 0) {
+        ::close(descriptor);
+        return Error::success(std::move(file));
+    }
+
+    void* data = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+    // the mapping keeps its own reference to the file
+    ::close(descriptor);
+
+    if (data == MAP_FAILED) {
+        return Error::failure<MappedFile>("Couldn't map " + path);
+    }
+
+    file.m_Data = static_cast<const uint8_t*>(data);
+    file.m_Size = static_cast<std::size_t>(status.st_size);
+#endif
+
+    return Error::success(std::move(file));
+}
@@ -0,0 +1,152 @@
+#ifdef GRAPH_PLOTTER_PROFILE
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "System/Profiler.hpp"
+
+struct ProfileEvent {
+    const char* Name;
+    int64_t Start;
+    int64_t Duration;
+};
+
+// written only by its owning thread, Count is published with release so a reader sees complete events
+struct ProfileChunk {
+    static constexpr std::size_t Capacity = 16384u;
+
+    ProfileEvent Events[Capacity];
+    std::atomic<std::size_t> Count{0u};
+    std::atomic<ProfileChunk*> Next{nullptr};
+
+    // owns the chunk Next points to, set once by the owning thread
+    std::unique_ptr<ProfileChunk> Owned;
+};
+
+struct ProfileBuffer {
+    uint32_t ThreadId;
+
+    std::unique_ptr<ProfileChunk> Head;
+    ProfileChunk* Tail;
+
+    // events lost because no chunk could be allocated for them
+    std::atomic<uint64_t> Dropped{0u};
+};
+
+// buffers live until exit so a thread that ends never leaves a dangling entry
+struct ProfileRegistry {
+    std::mutex Mutex;
+    std::vector<std::unique_ptr<ProfileBuffer>> Buffers;
+};
+
+ProfileRegistry& GetRegistry() {
+    static ProfileRegistry registry;
+    return registry;
+}
+
+// null when the buffer couldn't be allocated, the thread then records nothing
+ProfileBuffer* GetThreadBuffer() noexcept {
+    thread_local ProfileBuffer* buffer = []() noexcept -> ProfileBuffer* {
+        try {
+            ProfileRegistry& registry = GetRegistry();
+            std::lock_guard lock(registry.Mutex);
+
+            auto created = std::make_unique<ProfileBuffer>();
+            created->ThreadId = static_cast<uint32_t>(registry.Buffers.size());
+            created->Head = std::make_unique<ProfileChunk>();
+            created->Tail = created->Head.get();
+
+            registry.Buffers.push_back(std::move(created));
+            return registry.Buffers.back().get();
+        } catch (...) {
+            return nullptr;
+        }
+    }();
+
+    return buffer;
+}
+
+int64_t System::Profiler::Now() noexcept {
+    static const auto origin = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+void System::Profiler::Record(const char* name, int64_t start, int64_t end) noexcept {
+    ProfileBuffer* buffer = GetThreadBuffer();
+
+    if (!buffer) [[unlikely]] {
+        return;
+    }
+
+    ProfileChunk* chunk = buffer->Tail;
+
+    std::size_t count = chunk->Count.load(std::memory_order_relaxed);
+
+    if (count == ProfileChunk::Capacity) [[unlikely]] {
+        // without memory for another chunk the event is dropped rather than thrown out of a destructor
+        ProfileChunk* next = new (std::nothrow) ProfileChunk;
+
+        if (!next) {
+            buffer->Dropped.fetch_add(1u, std::memory_order_relaxed);
+            return;
+        }
+
+        // Owned is only touched by this thread, the reader follows Next
+        chunk->Owned.reset(next);
+        chunk->Next.store(next, std::memory_order_release);
+        buffer->Tail = chunk = next;
+        count = 0u;
+    }
+
+    chunk->Events[count] = {name, start, end - start};
+    chunk->Count.store(count + 1u, std::memory_order_release);
+}
+
+bool System::Profiler::WriteTrace(const std::string& path) {
+    std::ofstream file(path);
+
+    if (!file) {
+        return false;
+    }
+
+    ProfileRegistry& registry = GetRegistry();
+    std::lock_guard lock(registry.Mutex);
+
+    file << "{\"traceEvents\":[\n";
+
+    bool first = true;
+
+    for (const auto& buffer : registry.Buffers) {
+        file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << buffer->ThreadId
+             << ",\"args\":{\"name\":\"thread " << buffer->ThreadId;
+
+        if (const uint64_t dropped = buffer->Dropped.load(std::memory_order_relaxed)) {
+            file << " (" << dropped << " spans dropped)";
+        }
+
+        file << "\"}}";
+        first = false;
+
+        for (const ProfileChunk* chunk = buffer->Head.get(); chunk; chunk = chunk->Next.load(std::memory_order_acquire)) {
+            const std::size_t count = chunk->Count.load(std::memory_order_acquire);
+
+            for (std::size_t i = 0u; i < count; ++i) {
+                const ProfileEvent& event = chunk->Events[i];
+
+                file << ",\n{\"name\":\"" << event.Name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer->ThreadId
+                     << ",\"ts\":" << event.Start << ",\"dur\":" << event.Duration << "}";
+            }
+        }
+    }
+
+    file << "\n]}\n";
+
+    return static_cast<bool>(file);
+}
+
+#endif
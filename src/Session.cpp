@@ -0,0 +1,358 @@
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <unordered_set>
+
+#include "App/Session.hpp"
+
+// Layout, every value in native byte order:
+//   header       64 bytes, see below
+//   equations    per equation a uint32 length followed by its characters
+//   samples      at a multiple of PageSize: one CurveRecordSize record per curve, then the point and level arrays,
+//                each starting at a multiple of 8; a curve record is the key, the offset of its points, the point
+//                and level counts, the offset of its levels, one byte per point, the viewport the points belong to
+//                as offset, size and zoom, a zoom of 0 when they span the domain, and the zoom of the coarsest level;
+//                offsets count from the start of the section
+// Curves of older versions are keyed differently and never found: version 1 had no viewport and version 2 kept
+// a list of indices per level.
+constexpr char SessionMagic[8] = {'G', 'R', 'P', 'H', 'S', 'E', 'S', 'N'};
+
+constexpr std::size_t SessionHeaderSize = 64u;
+constexpr std::size_t CurveRecordSize = 64u;
+
+// header fields
+constexpr std::size_t VersionField = 8u;
+constexpr std::size_t EquationCountField = 12u;
+constexpr std::size_t PositionField = 16u;
+constexpr std::size_t ZoomField = 24u;
+constexpr std::size_t CurveCountField = 28u;
+constexpr std::size_t SectionOffsetField = 32u;
+constexpr std::size_t SectionSizeField = 40u;
+
+static_assert(sizeof(sf::Vector2f) == 2u * sizeof(float), "points are written as pairs of floats");
+
+#pragma region Buffer
+
+template <typename T>
+void PutValue(std::vector<uint8_t>& buffer, std::size_t offset, const T& value) {
+    std::memcpy(buffer.data() + offset, &value, sizeof(T));
+}
+
+template <typename T>
+void AppendValue(std::vector<uint8_t>& buffer, const T& value) {
+    buffer.resize(buffer.size() + sizeof(T));
+    PutValue(buffer, buffer.size() - sizeof(T), value);
+}
+
+void AppendBytes(std::vector<uint8_t>& buffer, const void* data, std::size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    buffer.insert(buffer.end(), bytes, bytes + size);
+}
+
+void AlignBuffer(std::vector<uint8_t>& buffer, std::size_t alignment) {
+    buffer.resize((buffer.size() + alignment - 1u) / alignment * alignment, 0u);
+}
+
+// false when [offset, offset + size) is not within the file
+bool ReadBytes(const System::MappedFile& file, std::size_t offset, void* out, std::size_t size) {
+    if (offset > file.GetSize() || size > file.GetSize() - offset) {
+        return false;
+    }
+
+    if (size) {
+        std::memcpy(out, file.GetData() + offset, size);
+    }
+
+    return true;
+}
+
+template <typename T>
+bool ReadValue(const System::MappedFile& file, std::size_t offset, T& value) {
+    return ReadBytes(file, offset, &value, sizeof(T));
+}
+
+inline bool WithinSection(uint64_t offset, uint64_t size, uint64_t sectionSize) {
+    return offset <= sectionSize && size <= sectionSize - offset;
+}
+
+#pragma region Session
+
+uint64_t Session::Key(const std::string& source, const Graph::SamplingSettings& settings) {
+    // 64 bit FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+
+    const auto mix = [&hash](const void* data, std::size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+        for (std::size_t i = 0u; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+
+    mix(&Version, sizeof(Version));
+    mix(source.data(), source.size());
+
+    mix(&settings.Tolerance, sizeof(settings.Tolerance));
+    mix(&settings.MinBendCosine, sizeof(settings.MinBendCosine));
+    mix(&settings.PointBudget, sizeof(settings.PointBudget));
+    mix(&settings.InitialSegments, sizeof(settings.InitialSegments));
+    mix(&settings.MaxDepth, sizeof(settings.MaxDepth));
+
+    return hash;
+}
+
+std::optional<std::string> Session::Save(const std::string& path, const View& view, const std::vector<Graph>& graphs) {
+    std::vector<uint8_t> buffer(SessionHeaderSize, 0u);
+
+    uint32_t equationCount = 0u;
+
+    // graphs still sampling are saved as equations only, the same equation twice shares its curve
+    std::vector<std::pair<uint64_t, const Graph*>> curves;
+    std::unordered_set<uint64_t> keys;
+
+    for (const Graph& graph : graphs) {
+        const std::string& source = graph.GetSource();
+
+        if (source.empty() || source.size() > UINT32_MAX) {
+            continue;
+        }
+
+        AppendValue(buffer, static_cast<uint32_t>(source.size()));
+        AppendBytes(buffer, source.data(), source.size());
+        ++equationCount;
+
+        const uint64_t key = Key(source, graph.GetSamplingSettings());
+
+        if (!graph.IsPending() && !graph.GetPoints().empty() && graph.GetPoints().size() <= UINT32_MAX && keys.insert(key).second) {
+            curves.emplace_back(key, &graph);
+        }
+    }
+
+    uint64_t sectionOffset = 0u;
+    uint64_t sectionSize = 0u;
+
+    if (!curves.empty()) {
+        AlignBuffer(buffer, PageSize);
+
+        const std::size_t section = buffer.size();
+        buffer.resize(section + curves.size() * CurveRecordSize, 0u);
+
+        for (std::size_t i = 0u; i < curves.size(); ++i) {
+            const std::vector<sf::Vector2f>& points = curves[i].second->GetPoints();
+            const Graph::LevelOfDetail& lod = curves[i].second->GetLod();
+
+            AlignBuffer(buffer, 8u);
+            const uint64_t pointsOffset = buffer.size() - section;
+            AppendBytes(buffer, points.data(), points.size() * sizeof(sf::Vector2f));
+
+            // a graph always has a level per point, the check only keeps a stale one out of the file
+            const bool hasLevels = lod.Levels.size() == points.size();
+
+            AlignBuffer(buffer, 8u);
+            const uint64_t levelsOffset = buffer.size() - section;
+
+            if (hasLevels) {
+                AppendBytes(buffer, lod.Levels.data(), lod.Levels.size());
+            }
+
+            const std::size_t record = section + i * CurveRecordSize;
+            PutValue(buffer, record, curves[i].first);
+            PutValue(buffer, record + 8u, pointsOffset);
+            PutValue(buffer, record + 16u, static_cast<uint32_t>(points.size()));
+            PutValue(buffer, record + 20u, static_cast<uint32_t>(hasLevels ? lod.LevelCount : 0u));
+            PutValue(buffer, record + 24u, levelsOffset);
+            PutValue(buffer, record + 52u, lod.Zoom);
+
+            if (const std::optional<Graph::Viewport>& viewport = curves[i].second->GetViewport()) {
+                PutValue(buffer, record + 32u, viewport->Offset.x);
+                PutValue(buffer, record + 36u, viewport->Offset.y);
+                PutValue(buffer, record + 40u, viewport->Size.x);
+                PutValue(buffer, record + 44u, viewport->Size.y);
+                PutValue(buffer, record + 48u, viewport->Zoom);
+            }
+        }
+
+        sectionOffset = section;
+        sectionSize = buffer.size() - section;
+    }
+
+    std::memcpy(buffer.data(), SessionMagic, sizeof(SessionMagic));
+    PutValue(buffer, VersionField, Version);
+    PutValue(buffer, EquationCountField, equationCount);
+    PutValue(buffer, PositionField, view.Position.x);
+    PutValue(buffer, PositionField + 4u, view.Position.y);
+    PutValue(buffer, ZoomField, view.Zoom);
+    PutValue(buffer, CurveCountField, static_cast<uint32_t>(curves.size()));
+    PutValue(buffer, SectionOffsetField, sectionOffset);
+    PutValue(buffer, SectionSizeField, sectionSize);
+
+    // written next to the old file and moved over it, so a failed save never loses the previous session
+    const std::string temporary = path + ".tmp";
+
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+
+        if (!file) {
+            return "Couldn't write " + temporary;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+
+    if (error) {
+        std::filesystem::remove(temporary, error);
+        return "Couldn't replace " + path;
+    }
+
+    return std::nullopt;
+}
+
+System::Error::ResultWrapper<Session> Session::Load(const std::string& path) {
+    auto mapped = System::MappedFile::Open(path);
+
+    if (!mapped) {
+        return System::Error::failure<Session>(mapped.error());
+    }
+
+    Session session;
+    session.m_File = std::move(mapped).value();
+
+    const System::MappedFile& file = session.m_File;
+
+    char magic[sizeof(SessionMagic)];
+    uint32_t version = 0u;
+
+    if (!ReadBytes(file, 0u, magic, sizeof(magic)) || std::memcmp(magic, SessionMagic, sizeof(magic)) != 0 || file.GetSize() < SessionHeaderSize) {
+        return System::Error::failure<Session>(path + " is not a session file");
+    }
+
+    if (!ReadValue(file, VersionField, version) || version < 1u || version > Version) {
+        return System::Error::failure<Session>(path + " was saved by an unsupported version");
+    }
+
+    uint32_t equationCount = 0u;
+    uint32_t curveCount = 0u;
+    uint64_t sectionOffset = 0u;
+    uint64_t sectionSize = 0u;
+
+    ReadValue(file, EquationCountField, equationCount);
+    ReadValue(file, PositionField, session.m_View.Position.x);
+    ReadValue(file, PositionField + 4u, session.m_View.Position.y);
+    ReadValue(file, ZoomField, session.m_View.Zoom);
+    ReadValue(file, CurveCountField, curveCount);
+    ReadValue(file, SectionOffsetField, sectionOffset);
+    ReadValue(file, SectionSizeField, sectionSize);
+
+    // the equations and the view of an older session still open, its curves are sampled again
+    if (version != Version) {
+        curveCount = 0u;
+    }
+
+    const std::string corrupted = path + " is corrupted";
+
+    std::size_t offset = SessionHeaderSize;
+
+    for (uint32_t i = 0u; i < equationCount; ++i) {
+        uint32_t length = 0u;
+
+        if (!ReadValue(file, offset, length) || length > file.GetSize() - offset - sizeof(length)) {
+            return System::Error::failure<Session>(corrupted);
+        }
+
+        session.m_Equations.emplace_back(reinterpret_cast<const char*>(file.GetData() + offset + sizeof(length)), length);
+        offset += sizeof(length) + length;
+    }
+
+    if (!curveCount) {
+        return System::Error::success(std::move(session));
+    }
+
+    if (sectionOffset % PageSize || sectionOffset < offset || !WithinSection(sectionOffset, sectionSize, file.GetSize())) {
+        return System::Error::failure<Session>(corrupted);
+    }
+
+    session.m_SectionOffset = static_cast<std::size_t>(sectionOffset);
+
+    if (!WithinSection(0u, static_cast<uint64_t>(curveCount) * CurveRecordSize, sectionSize)) {
+        return System::Error::failure<Session>(corrupted);
+    }
+
+    // only the records are read here, the points stay on disk until a curve is restored
+    for (uint32_t i = 0u; i < curveCount; ++i) {
+        const std::size_t record = session.m_SectionOffset + i * CurveRecordSize;
+
+        uint64_t key = 0u;
+        CurveRecord curve{};
+
+        ReadValue(file, record, key);
+        ReadValue(file, record + 8u, curve.PointsOffset);
+        ReadValue(file, record + 16u, curve.PointCount);
+        ReadValue(file, record + 20u, curve.LevelCount);
+        ReadValue(file, record + 24u, curve.LevelsOffset);
+        ReadValue(file, record + 52u, curve.LevelZoom);
+
+        Graph::Viewport viewport{};
+        ReadValue(file, record + 32u, viewport.Offset.x);
+        ReadValue(file, record + 36u, viewport.Offset.y);
+        ReadValue(file, record + 40u, viewport.Size.x);
+        ReadValue(file, record + 44u, viewport.Size.y);
+        ReadValue(file, record + 48u, viewport.Zoom);
+
+        if (viewport.Zoom > 0.f) {
+            curve.View = viewport;
+        }
+
+        if (
+            !WithinSection(curve.PointsOffset, static_cast<uint64_t>(curve.PointCount) * sizeof(sf::Vector2f), sectionSize) ||
+            curve.LevelCount >= Graph::LevelOfDetail::Never ||
+            !WithinSection(curve.LevelsOffset, curve.LevelCount ? curve.PointCount : 0u, sectionSize)
+        ) {
+            return System::Error::failure<Session>(corrupted);
+        }
+
+        session.m_Curves[key] = curve;
+    }
+
+    return System::Error::success(std::move(session));
+}
+
+std::optional<Graph::Curve> Session::FindCurve(const std::string& source, const Graph::SamplingSettings& settings) const {
+    const auto it = m_Curves.find(Key(source, settings));
+
+    if (it == m_Curves.end()) {
+        return std::nullopt;
+    }
+
+    const CurveRecord& record = it->second;
+
+    // without levels nothing would be drawn, the curve is sampled again instead
+    if (!record.LevelCount || !(record.LevelZoom > 0.f)) {
+        return std::nullopt;
+    }
+
+    Graph::Curve curve;
+    curve.View = record.View;
+    curve.Points.resize(record.PointCount);
+
+    if (!ReadBytes(m_File, m_SectionOffset + record.PointsOffset, curve.Points.data(), curve.Points.size() * sizeof(sf::Vector2f))) {
+        return std::nullopt;
+    }
+
+    curve.Lod.Zoom = record.LevelZoom;
+    curve.Lod.LevelCount = static_cast<uint8_t>(record.LevelCount);
+    curve.Lod.Levels.resize(record.PointCount);
+
+    if (!ReadBytes(m_File, m_SectionOffset + record.LevelsOffset, curve.Lod.Levels.data(), curve.Lod.Levels.size())) {
+        return std::nullopt;
+    }
+
+    for (uint8_t level : curve.Lod.Levels) {
+        if (level >= record.LevelCount && level != Graph::LevelOfDetail::Never) {
+            return std::nullopt;
+        }
+    }
+
+    return curve;
+}
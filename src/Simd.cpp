@@ -0,0 +1,216 @@
+#include <cmath>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <iterator>
+#include <limits>
+#include <utility>
+
+#include "Math/Simd.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define GRAPH_SIMD_X86_64
+
+    #include <immintrin.h>
+
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #endif
+#endif
+
+using Math::OpCode;
+using Math::Simd::kernel_t;
+
+#pragma region Scalar
+
+template <OpCode Op>
+void ScalarKernel(double* dst, const double* a, const double* b, std::size_t count) {
+    for (std::size_t i = 0u; i < count; ++i) {
+        dst[i] = Math::Apply(Op, a[i], b[i]);
+    }
+}
+
+template <std::size_t... I>
+constexpr std::array<kernel_t, Math::OpCodeCount> MakeScalarTable(std::index_sequence<I...>) {
+    return {ScalarKernel<static_cast<OpCode>(I)>...};
+}
+
+#ifdef GRAPH_SIMD_X86_64
+
+#pragma region SSE2
+
+namespace Sse2Kernels {
+    using V = __m128d;
+
+    constexpr std::size_t Width = 2u;
+
+    inline V Set(double x) { return _mm_set1_pd(x); }
+    inline V Load(const double* p) { return _mm_loadu_pd(p); }
+    inline void Store(double* p, V v) { _mm_storeu_pd(p, v); }
+
+    inline V Add(V a, V b) { return _mm_add_pd(a, b); }
+    inline V Sub(V a, V b) { return _mm_sub_pd(a, b); }
+    inline V Mul(V a, V b) { return _mm_mul_pd(a, b); }
+    inline V Div(V a, V b) { return _mm_div_pd(a, b); }
+    inline V Fma(V a, V b, V c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+    inline V Sqrt(V a) { return _mm_sqrt_pd(a); }
+
+    inline V And(V a, V b) { return _mm_and_pd(a, b); }
+    inline V Or(V a, V b) { return _mm_or_pd(a, b); }
+    inline V Xor(V a, V b) { return _mm_xor_pd(a, b); }
+    inline V AndNot(V a, V b) { return _mm_andnot_pd(a, b); }
+    inline V Not(V a) { return _mm_xor_pd(a, _mm_castsi128_pd(_mm_set1_epi32(-1))); }
+    inline V Abs(V a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+    inline V Select(V mask, V a, V b) { return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b)); }
+
+    inline V Less(V a, V b) { return _mm_cmplt_pd(a, b); }
+    inline V Greater(V a, V b) { return _mm_cmpgt_pd(a, b); }
+    inline V GreaterEqual(V a, V b) { return _mm_cmpge_pd(a, b); }
+    inline V Equal(V a, V b) { return _mm_cmpeq_pd(a, b); }
+    inline V NotEqual(V a, V b) { return _mm_cmpneq_pd(a, b); }
+    inline int Mask(V a) { return _mm_movemask_pd(a); }
+
+    inline V ShiftLeft52(V a) { return _mm_castsi128_pd(_mm_slli_epi64(_mm_castpd_si128(a), 52)); }
+    inline V ShiftRight52(V a) { return _mm_castsi128_pd(_mm_srli_epi64(_mm_castpd_si128(a), 52)); }
+
+    #include "SimdKernels.inl"
+}
+
+#pragma region AVX2
+
+#if defined(__clang__)
+    #pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+#elif defined(__GNUC__)
+    #pragma GCC push_options
+    #pragma GCC target("avx2,fma")
+#endif
+
+namespace Avx2Kernels {
+    using V = __m256d;
+
+    constexpr std::size_t Width = 4u;
+
+    inline V Set(double x) { return _mm256_set1_pd(x); }
+    inline V Load(const double* p) { return _mm256_loadu_pd(p); }
+    inline void Store(double* p, V v) { _mm256_storeu_pd(p, v); }
+
+    inline V Add(V a, V b) { return _mm256_add_pd(a, b); }
+    inline V Sub(V a, V b) { return _mm256_sub_pd(a, b); }
+    inline V Mul(V a, V b) { return _mm256_mul_pd(a, b); }
+    inline V Div(V a, V b) { return _mm256_div_pd(a, b); }
+    inline V Fma(V a, V b, V c) { return _mm256_fmadd_pd(a, b, c); }
+    inline V Sqrt(V a) { return _mm256_sqrt_pd(a); }
+
+    inline V And(V a, V b) { return _mm256_and_pd(a, b); }
+    inline V Or(V a, V b) { return _mm256_or_pd(a, b); }
+    inline V Xor(V a, V b) { return _mm256_xor_pd(a, b); }
+    inline V AndNot(V a, V b) { return _mm256_andnot_pd(a, b); }
+    inline V Not(V a) { return _mm256_xor_pd(a, _mm256_castsi256_pd(_mm256_set1_epi32(-1))); }
+    inline V Abs(V a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+    inline V Select(V mask, V a, V b) { return _mm256_blendv_pd(b, a, mask); }
+
+    inline V Less(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+    inline V Greater(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+    inline V GreaterEqual(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+    inline V Equal(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+    inline V NotEqual(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_NEQ_UQ); }
+    inline int Mask(V a) { return _mm256_movemask_pd(a); }
+
+    inline V ShiftLeft52(V a) { return _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_castpd_si256(a), 52)); }
+    inline V ShiftRight52(V a) { return _mm256_castsi256_pd(_mm256_srli_epi64(_mm256_castpd_si256(a), 52)); }
+
+    #include "SimdKernels.inl"
+}
+
+#if defined(__clang__)
+    #pragma clang attribute pop
+#elif defined(__GNUC__)
+    #pragma GCC pop_options
+#endif
+
+#endif
+
+#pragma region Dispatch
+
+Math::Simd::Isa DetectIsa() {
+#if defined(GRAPH_SIMD_X86_64) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return Math::Simd::Isa::Avx2;
+    }
+
+    return Math::Simd::Isa::Sse2;
+#elif defined(GRAPH_SIMD_X86_64) && defined(_MSC_VER)
+    int info[4];
+
+    __cpuid(info, 1);
+    const bool fma = info[2] & (1 << 12);
+    const bool osxsave = info[2] & (1 << 27);
+
+    __cpuidex(info, 7, 0);
+    const bool avx2 = info[1] & (1 << 5);
+
+    // the os has to save the ymm registers on context switches as well
+    if (fma && avx2 && osxsave && (_xgetbv(0) & 6u) == 6u) {
+        return Math::Simd::Isa::Avx2;
+    }
+
+    return Math::Simd::Isa::Sse2;
+#else
+    return Math::Simd::Isa::Scalar;
+#endif
+}
+
+typedef std::array<std::array<kernel_t, Math::OpCodeCount>, 3u> kernel_tables_t;
+
+const kernel_tables_t& GetKernelTables() {
+    static const kernel_tables_t tables = [] {
+        kernel_tables_t result;
+
+        result[0] = MakeScalarTable(std::make_index_sequence<Math::OpCodeCount>());
+        result[1] = result[0];
+        result[2] = result[0];
+
+#ifdef GRAPH_SIMD_X86_64
+        Sse2Kernels::FillKernels(result[1].data());
+        Avx2Kernels::FillKernels(result[2].data());
+#endif
+
+        return result;
+    }();
+
+    return tables;
+}
+
+std::atomic<Math::Simd::Isa>& ActiveIsa() {
+    static std::atomic<Math::Simd::Isa> isa{Math::Simd::GetSupportedIsa()};
+    return isa;
+}
+
+Math::Simd::Isa Math::Simd::GetSupportedIsa() noexcept {
+    static const Isa supported = DetectIsa();
+    return supported;
+}
+
+Math::Simd::Isa Math::Simd::GetIsa() noexcept {
+    return ActiveIsa().load(std::memory_order_relaxed);
+}
+
+void Math::Simd::SetIsa(Isa isa) noexcept {
+    ActiveIsa().store(std::min(isa, GetSupportedIsa()), std::memory_order_relaxed);
+}
+
+const char* Math::Simd::GetIsaName(Isa isa) noexcept {
+    switch (isa) {
+        case Isa::Scalar: return "scalar";
+        case Isa::Sse2: return "sse2";
+        case Isa::Avx2: return "avx2";
+    }
+
+    return "unknown";
+}
+
+Math::Simd::kernel_t Math::Simd::GetKernel(OpCode op) noexcept {
+    return GetKernelTables()[static_cast<std::size_t>(GetIsa())][static_cast<std::size_t>(op)];
+}
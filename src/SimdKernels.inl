@@ -0,0 +1,259 @@
+// Vector kernels shared by every instruction set.
+// Included by Simd.cpp inside a namespace that defines the vector type V, its Width and the primitive wrappers,
+// so the same code is compiled once per target.
+
+constexpr double RoundingMagic = 6755399441055744.0; // 1.5 * 2^52, adding it rounds to the nearest integer
+
+constexpr double Ln2Hi = 6.93147180369123816490e-01;
+constexpr double Ln2Lo = 1.90821492927058770002e-10;
+
+inline V Round(V x) {
+    // exact for |x| < 2^51
+    return Sub(Add(x, Set(RoundingMagic)), Set(RoundingMagic));
+}
+
+// 2^n for integral n in [-1022, 1023], built directly in the exponent field
+inline V Exp2Integral(V n) {
+    return ShiftLeft52(Add(n, Set(1023.0 + RoundingMagic)));
+}
+
+inline V Polynomial(V x, const double* coefficients, std::size_t count) {
+    V result = Set(coefficients[count - 1u]);
+
+    for (std::size_t i = count - 1u; i-- > 0u;) {
+        result = Fma(result, x, Set(coefficients[i]));
+    }
+
+    return result;
+}
+
+inline V ExpV(V x) {
+    constexpr double Overflow = 709.782712893383973096;
+    constexpr double Underflow = -707.0; // results below are flushed to zero
+
+    // Taylor series of e^r up to r^13, |r| <= ln(2) / 2
+    constexpr double Coefficients[] = {
+        1.0, 1.0, 1.0 / 2.0, 1.0 / 6.0, 1.0 / 24.0, 1.0 / 120.0, 1.0 / 720.0, 1.0 / 5040.0,
+        1.0 / 40320.0, 1.0 / 362880.0, 1.0 / 3628800.0, 1.0 / 39916800.0, 1.0 / 479001600.0, 1.0 / 6227020800.0
+    };
+
+    const V overflow = Greater(x, Set(Overflow));
+    const V underflow = Less(x, Set(Underflow));
+
+    x = Select(Or(overflow, underflow), Set(0.0), x);
+
+    const V n = Round(Mul(x, Set(1.44269504088896340736)));
+    V r = Fma(n, Set(-Ln2Hi), x);
+    r = Fma(n, Set(-Ln2Lo), r);
+
+    const V p = Polynomial(r, Coefficients, std::size(Coefficients));
+
+    // scale by 2^(n - 1) * 2 so n = 1024 stays representable
+    V result = Mul(Mul(p, Exp2Integral(Sub(n, Set(1.0)))), Set(2.0));
+
+    result = Select(overflow, Set(std::numeric_limits<double>::infinity()), result);
+    result = Select(underflow, Set(0.0), result);
+
+    return result;
+}
+
+// natural logarithm for positive, normal, finite x
+inline V LogV(V x) {
+    constexpr double Lg1 = 6.666666666666735130e-01;
+    constexpr double Lg2 = 3.999999999940941908e-01;
+    constexpr double Lg3 = 2.857142874366239149e-01;
+    constexpr double Lg4 = 2.222219843214978396e-01;
+    constexpr double Lg5 = 1.818357216161805012e-01;
+    constexpr double Lg6 = 1.531383769920937332e-01;
+    constexpr double Lg7 = 1.479819860511658591e-01;
+
+    constexpr double TwoPow52 = 4503599627370496.0;
+
+    const V mantissaMask = Set(std::bit_cast<double>(uint64_t{0x000FFFFFFFFFFFFFu}));
+
+    // biased exponent, moved into the mantissa of 2^52
+    V exponent = Sub(Or(ShiftRight52(x), Set(TwoPow52)), Set(TwoPow52 + 1023.0));
+    V m = Or(And(x, mantissaMask), Set(1.0));
+
+    const V upper = Greater(m, Set(1.41421356237309504880));
+    m = Select(upper, Mul(m, Set(0.5)), m);
+    exponent = Select(upper, Add(exponent, Set(1.0)), exponent);
+
+    const V f = Sub(m, Set(1.0));
+    const V s = Div(f, Add(f, Set(2.0)));
+    const V z = Mul(s, s);
+    const V w = Mul(z, z);
+
+    const V t1 = Mul(w, Fma(w, Fma(w, Set(Lg6), Set(Lg4)), Set(Lg2)));
+    const V t2 = Mul(z, Fma(w, Fma(w, Fma(w, Set(Lg7), Set(Lg5)), Set(Lg3)), Set(Lg1)));
+    const V r = Add(t1, t2);
+
+    const V hfsq = Mul(Set(0.5), Mul(f, f));
+
+    // e * ln2_hi - ((hfsq - (s * (hfsq + R) + e * ln2_lo)) - f)
+    const V low = Fma(exponent, Set(Ln2Lo), Mul(s, Add(hfsq, r)));
+    return Sub(Mul(exponent, Set(Ln2Hi)), Sub(Sub(hfsq, low), f));
+}
+
+constexpr double ReductionLimit = 1.0e6; // three part Cody-Waite reduction is exact up to here
+
+// sin(x + quadrant * pi / 2)
+inline V SinV(V x, double quadrant) {
+    constexpr double PiOver2_1 = 1.57079632673412561417e+00;
+    constexpr double PiOver2_2 = 6.07710050630396597660e-11;
+    constexpr double PiOver2_3 = 2.02226624871116645580e-21;
+
+    constexpr double S[] = {
+        -1.66666666666666324348e-01, 8.33333333332248946124e-03, -1.98412698298579493134e-04,
+        2.75573137070700676789e-06, -2.50507602534068634195e-08, 1.58969099521155010221e-10
+    };
+
+    constexpr double C[] = {
+        4.16666666666666019037e-02, -1.38888888888741095749e-03, 2.48015872894767294178e-05,
+        -2.75573143513906633035e-07, 2.08757232129817482790e-09, -1.13596475577881948265e-11
+    };
+
+    const V k = Round(Mul(x, Set(0.636619772367581343076)));
+
+    V r = Fma(k, Set(-PiOver2_1), x);
+    r = Fma(k, Set(-PiOver2_2), r);
+    r = Fma(k, Set(-PiOver2_3), r);
+
+    // quadrant modulo 4, floor(q / 4) = round(q / 4 - 3 / 8) since q / 4 is a multiple of 1 / 4
+    const V q = Add(k, Set(quadrant));
+    const V octant = Sub(q, Mul(Set(4.0), Round(Fma(q, Set(0.25), Set(-0.375)))));
+
+    const V z = Mul(r, r);
+
+    const V sine = Fma(Mul(r, z), Polynomial(z, S, std::size(S)), r);
+    const V cosine = Fma(Mul(z, z), Polynomial(z, C, std::size(C)), Fma(z, Set(-0.5), Set(1.0)));
+
+    const V swap = Or(Equal(octant, Set(1.0)), Equal(octant, Set(3.0)));
+    const V negate = GreaterEqual(octant, Set(2.0));
+
+    return Xor(Select(swap, cosine, sine), And(negate, Set(-0.0)));
+}
+
+#pragma region Kernels
+
+template <V (*Operation)(V, V)>
+void BinaryKernel(double* dst, const double* a, const double* b, std::size_t count) {
+    for (std::size_t i = 0u; i < count; i += Width) {
+        Store(dst + i, Operation(Load(a + i), Load(b + i)));
+    }
+}
+
+inline V NegateV(V x, V) {
+    return Xor(x, Set(-0.0));
+}
+
+inline V AbsV(V x, V) {
+    return AndNot(Set(-0.0), x);
+}
+
+inline V SqrtV(V x, V) {
+    return Sqrt(x);
+}
+
+// vector path with a scalar redo of the whole vector when any lane is outside its domain
+template <V (*Vector)(V, V), V (*Special)(V, V), double (*Fallback)(double, double)>
+void GuardedKernel(double* dst, const double* a, const double* b, std::size_t count) {
+    alignas(32) double lanesA[Width];
+    alignas(32) double lanesB[Width];
+
+    for (std::size_t i = 0u; i < count; i += Width) {
+        const V x = Load(a + i);
+        const V y = Load(b + i);
+
+        const bool redo = Mask(Special(x, y)) != 0;
+
+        // dst may alias the inputs, keep a copy for the fallback
+        if (redo) [[unlikely]] {
+            Store(lanesA, x);
+            Store(lanesB, y);
+        }
+
+        Store(dst + i, Vector(x, y));
+
+        if (redo) [[unlikely]] {
+            for (std::size_t lane = 0u; lane < Width; ++lane) {
+                dst[i + lane] = Fallback(lanesA[lane], lanesB[lane]);
+            }
+        }
+    }
+}
+
+inline V SinV(V x, V) {
+    return SinV(x, 0.0);
+}
+
+inline V CosV(V x, V) {
+    return SinV(x, 1.0);
+}
+
+inline V ExpV(V x, V) {
+    return ExpV(x);
+}
+
+inline V LnV(V x, V) {
+    return LogV(x);
+}
+
+inline V Log10V(V x, V) {
+    return Mul(LogV(x), Set(0.434294481903251827651));
+}
+
+constexpr double IntegralLimit = 2251799813685248.0; // 2^51, beyond this Round is no longer exact
+
+inline V PowV(V x, V y) {
+    const V result = ExpV(Mul(y, LogV(Abs(x))));
+
+    // negative bases are only defined for integral exponents, odd ones keep the sign
+    const V negative = Less(x, Set(0.0));
+    const V integral = Equal(Round(y), y);
+    const V half = Mul(y, Set(0.5));
+    const V odd = And(integral, NotEqual(Round(half), half));
+
+    const V withSign = Select(And(negative, odd), Xor(result, Set(-0.0)), result);
+    return Select(AndNot(integral, negative), Set(std::numeric_limits<double>::quiet_NaN()), withSign);
+}
+
+inline V OutsideReduction(V x, V) {
+    return Greater(Abs(x), Set(ReductionLimit));
+}
+
+inline V Never(V, V) {
+    return Set(0.0);
+}
+
+inline V OutsideLogDomain(V x, V) {
+    // zero, negative, subnormal, infinite or NaN
+    return Not(And(GreaterEqual(x, Set(std::numeric_limits<double>::min())), Less(x, Set(std::numeric_limits<double>::infinity()))));
+}
+
+inline V OutsidePowDomain(V x, V y) {
+    return Or(OutsideLogDomain(Abs(x), y), Not(Less(Abs(y), Set(IntegralLimit))));
+}
+
+inline double SinScalar(double x, double) { return std::sin(x); }
+inline double CosScalar(double x, double) { return std::cos(x); }
+inline double ExpScalar(double x, double) { return std::exp(x); }
+inline double LnScalar(double x, double) { return std::log(x); }
+inline double Log10Scalar(double x, double) { return std::log10(x); }
+inline double PowScalar(double x, double y) { return std::pow(x, y); }
+
+void FillKernels(kernel_t* table) {
+    table[static_cast<std::size_t>(OpCode::Add)] = BinaryKernel<Add>;
+    table[static_cast<std::size_t>(OpCode::Sub)] = BinaryKernel<Sub>;
+    table[static_cast<std::size_t>(OpCode::Mul)] = BinaryKernel<Mul>;
+    table[static_cast<std::size_t>(OpCode::Div)] = BinaryKernel<Div>;
+    table[static_cast<std::size_t>(OpCode::Neg)] = BinaryKernel<NegateV>;
+    table[static_cast<std::size_t>(OpCode::Abs)] = BinaryKernel<AbsV>;
+    table[static_cast<std::size_t>(OpCode::Sqrt)] = BinaryKernel<SqrtV>;
+    table[static_cast<std::size_t>(OpCode::Sin)] = GuardedKernel<SinV, OutsideReduction, SinScalar>;
+    table[static_cast<std::size_t>(OpCode::Cos)] = GuardedKernel<CosV, OutsideReduction, CosScalar>;
+    table[static_cast<std::size_t>(OpCode::Exp)] = GuardedKernel<ExpV, Never, ExpScalar>;
+    table[static_cast<std::size_t>(OpCode::Ln)] = GuardedKernel<LnV, OutsideLogDomain, LnScalar>;
+    table[static_cast<std::size_t>(OpCode::Log10)] = GuardedKernel<Log10V, OutsideLogDomain, Log10Scalar>;
+    table[static_cast<std::size_t>(OpCode::Pow)] = GuardedKernel<PowV, OutsidePowDomain, PowScalar>;
+}
@@ -0,0 +1,317 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <utility>
+
+#include "App/Stream.hpp"
+#include "App/DataSeries.hpp"
+
+#include "System/Profiler.hpp"
+
+#ifdef _WIN32
+    #include <fcntl.h>
+    #include <io.h>
+#else
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <unistd.h>
+#endif
+
+#pragma region Reader
+
+// bytes asked for by one read, a few thousand rows
+constexpr std::size_t ReadSize = 1u << 16;
+
+// a line longer than this without a break is thrown away
+constexpr std::size_t MaxLineLength = 4096u;
+
+Stream::Stream(std::string path, double window, Overflow overflow)
+    : m_Shared(std::make_shared<Shared>()), m_Window(window), m_BucketWidth(window / BucketsPerWindow), m_Batch(4096u) {
+    m_Reader = std::thread(readerLoop, m_Shared, std::move(path), overflow);
+}
+
+Stream::~Stream() {
+    m_Shared->Stopping.store(true, std::memory_order_relaxed);
+
+#ifdef _WIN32
+    // a blocking read can't be interrupted, the reader finishes on its own with its own reference to the state
+    m_Reader.detach();
+#else
+    // nor can an open still waiting for a writer to connect; once open, the reader checks every poll timeout
+    if (m_Shared->Opened.load(std::memory_order_acquire)) {
+        m_Reader.join();
+    } else {
+        m_Reader.detach();
+    }
+#endif
+}
+
+System::Error::ResultWrapper<std::unique_ptr<Stream>> Stream::Open(const std::string& path, double window, Overflow overflow) {
+    if (!(window > 0.0) || !std::isfinite(window)) {
+        return System::Error::failure<std::unique_ptr<Stream>>("The window of a stream has to be a positive length of time");
+    }
+
+    std::error_code error;
+
+    if (path != "-" && !std::filesystem::exists(path, error)) {
+        return System::Error::failure<std::unique_ptr<Stream>>("Couldn't open " + path);
+    }
+
+    return System::Error::success(std::unique_ptr<Stream>(new Stream(path, window, overflow)));
+}
+
+void Stream::readerLoop(std::shared_ptr<Shared> shared, std::string path, Overflow overflow) {
+    const bool standardInput = path == "-";
+
+#ifdef _WIN32
+    const int descriptor = standardInput ? 0 : _open(path.c_str(), _O_RDONLY | _O_BINARY);
+#else
+    // opening a named pipe waits for a writer
+    const int descriptor = standardInput ? STDIN_FILENO : open(path.c_str(), O_RDONLY);
+#endif
+
+    if (descriptor < 0) {
+        shared->Closed.store(true, std::memory_order_release);
+        return;
+    }
+
+    shared->Opened.store(true, std::memory_order_release);
+
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<char> buffer(ReadSize);
+    std::string partial; // the end of the last read when it cut a line in two
+    std::vector<Sample> samples;
+    uint64_t malformed = 0u;
+
+    const auto parseLine = [&](const char* begin, const char* end) {
+        double row[2];
+        const unsigned int count = DataSeries::ParseRow(begin, end, row, 2u);
+
+        if (count == 2u) {
+            samples.push_back({row[0], row[1]});
+        } else if (count == 1u) {
+            samples.push_back({std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), row[0]});
+        } else if (std::any_of(begin, end, [](char c) { return c != ' ' && c != '\t' && c != '\r'; })) {
+            ++malformed;
+        }
+    };
+
+    const auto deliver = [&] {
+        shared->Received.fetch_add(samples.size(), std::memory_order_relaxed);
+        shared->Malformed.fetch_add(std::exchange(malformed, 0u), std::memory_order_relaxed);
+
+        std::size_t pushed = 0u;
+        bool stalled = false;
+
+        while (pushed < samples.size()) {
+            pushed += shared->Ring.Push(samples.data() + pushed, samples.size() - pushed);
+
+            if (pushed == samples.size() || shared->Stopping.load(std::memory_order_relaxed)) {
+                break;
+            }
+
+            if (overflow == Overflow::Drop) {
+                shared->Dropped.fetch_add(samples.size() - pushed, std::memory_order_relaxed);
+                break;
+            }
+
+            if (!stalled) {
+                shared->Stalls.fetch_add(1u, std::memory_order_relaxed);
+                stalled = true;
+            }
+
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+
+        samples.clear();
+    };
+
+    while (!shared->Stopping.load(std::memory_order_relaxed)) {
+#ifdef _WIN32
+        const int count = _read(descriptor, buffer.data(), static_cast<unsigned int>(buffer.size()));
+#else
+        // wakes up now and then to see whether the stream was closed
+        pollfd request{descriptor, POLLIN, 0};
+        const int ready = poll(&request, 1, 100);
+
+        if (ready == 0 || (ready < 0 && errno == EINTR)) {
+            continue;
+        }
+
+        if (ready < 0) {
+            break;
+        }
+
+        const ssize_t count = read(descriptor, buffer.data(), buffer.size());
+
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+#endif
+
+        // the writer is gone
+        if (count <= 0) {
+            break;
+        }
+
+        const char* begin = buffer.data();
+        const char* const end = begin + count;
+
+        while (begin < end) {
+            const char* lineEnd = static_cast<const char*>(std::memchr(begin, '\n', static_cast<std::size_t>(end - begin)));
+
+            if (!lineEnd) {
+                partial.append(begin, end);
+
+                if (partial.size() > MaxLineLength) {
+                    partial.clear();
+                    ++malformed;
+                }
+
+                break;
+            }
+
+            if (partial.empty()) {
+                parseLine(begin, lineEnd);
+            } else {
+                partial.append(begin, lineEnd);
+                parseLine(partial.data(), partial.data() + partial.size());
+                partial.clear();
+            }
+
+            begin = lineEnd + 1;
+        }
+
+        deliver();
+    }
+
+    // the last line may go without a break
+    if (!partial.empty()) {
+        parseLine(partial.data(), partial.data() + partial.size());
+        deliver();
+    }
+
+    if (!standardInput) {
+#ifdef _WIN32
+        _close(descriptor);
+#else
+        close(descriptor);
+#endif
+    }
+
+    shared->Closed.store(true, std::memory_order_release);
+}
+
+#pragma region Buckets
+
+void Stream::Tail(std::vector<sf::Vector2f>& points) const {
+    if (m_BucketEmpty) {
+        return;
+    }
+
+    const Sample& first = m_Low.T <= m_High.T ? m_Low : m_High;
+    const Sample& second = m_Low.T <= m_High.T ? m_High : m_Low;
+
+    points.emplace_back(static_cast<float>(first.T - m_Base), static_cast<float>(-first.Y));
+
+    if (second.T != first.T || second.Y != first.Y) {
+        points.emplace_back(static_cast<float>(second.T - m_Base), static_cast<float>(-second.Y));
+    }
+}
+
+void Stream::flushBucket(std::vector<sf::Vector2f>& points) {
+    Tail(points);
+    m_BucketEmpty = true;
+}
+
+void Stream::Drain(std::vector<sf::Vector2f>& points) {
+    PROFILE_SCOPE("Stream::Drain");
+
+    // read before popping, so when it is set the ring holds every sample there will ever be
+    const bool closed = m_Shared->Closed.load(std::memory_order_acquire);
+
+    while (const std::size_t count = m_Shared->Ring.Pop(m_Batch.data(), m_Batch.size())) {
+        for (std::size_t i = 0u; i < count; ++i) {
+            const Sample& sample = m_Batch[i];
+
+            if (!std::isfinite(sample.T)) {
+                continue;
+            }
+
+            if (!m_HasBase) {
+                m_Base = sample.T;
+                m_HasBase = true;
+            }
+
+            const double x = sample.T - m_Base;
+            const double position = std::floor(x / m_BucketWidth);
+
+            // far outside of anything a window could show
+            if (!(std::abs(position) < 1e15)) {
+                continue;
+            }
+
+            // samples that arrive late join the bucket being filled
+            const int64_t bucket = std::max(m_Bucket, static_cast<int64_t>(position));
+
+            if (bucket != m_Bucket) {
+                flushBucket(points);
+                m_Bucket = bucket;
+            }
+
+            m_Latest = std::max(m_Latest, x);
+
+            if (!std::isfinite(sample.Y)) {
+                flushBucket(points);
+                points.emplace_back(static_cast<float>(x), std::numeric_limits<float>::quiet_NaN());
+                continue;
+            }
+
+            if (m_BucketEmpty) {
+                m_Low = sample;
+                m_High = sample;
+                m_BucketEmpty = false;
+            } else if (sample.Y < m_Low.Y) {
+                m_Low = sample;
+            } else if (sample.Y > m_High.Y) {
+                m_High = sample;
+            }
+        }
+
+        if (count < m_Batch.size()) {
+            break;
+        }
+    }
+
+    // nothing can join the last bucket anymore
+    if (closed && !m_Shared->Ring.GetSize()) {
+        flushBucket(points);
+    }
+}
+
+double Stream::Rebase(double x) {
+    const double buckets = std::floor(x / m_BucketWidth);
+    const double shift = buckets * m_BucketWidth;
+
+    m_Base += shift;
+    m_Bucket -= static_cast<int64_t>(buckets);
+    m_Latest -= shift;
+
+    return shift;
+}
+
+Stream::Stats Stream::GetStats() const {
+    return {
+        m_Shared->Received.load(std::memory_order_relaxed),
+        m_Shared->Dropped.load(std::memory_order_relaxed),
+        m_Shared->Malformed.load(std::memory_order_relaxed),
+        m_Shared->Stalls.load(std::memory_order_relaxed),
+        m_Shared->Ring.GetSize(),
+        m_Shared->Closed.load(std::memory_order_acquire)
+    };
+}
@@ -0,0 +1,114 @@
+#include <atomic>
+#include <memory>
+#include <algorithm>
+
+#include "System/ThreadPool.hpp"
+
+System::ThreadPool::ThreadPool(unsigned int workerCount) {
+    m_Workers.reserve(workerCount);
+
+    for (unsigned int i = 0u; i < workerCount; ++i) {
+        m_Workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+System::ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(m_Mutex);
+        m_Stopping = true;
+    }
+
+    m_Condition.notify_all();
+
+    for (std::thread& worker : m_Workers) {
+        worker.join();
+    }
+}
+
+System::ThreadPool& System::ThreadPool::Shared() {
+    // at least one worker so background jobs never run on the calling thread
+    static ThreadPool pool(std::max(2u, std::thread::hardware_concurrency()) - 1u);
+    return pool;
+}
+
+void System::ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+
+        {
+            std::unique_lock lock(m_Mutex);
+            m_Condition.wait(lock, [this] { return m_Stopping || !m_Tasks.empty(); });
+
+            if (m_Tasks.empty()) {
+                return;
+            }
+
+            task = std::move(m_Tasks.front());
+            m_Tasks.pop_front();
+        }
+
+        task();
+    }
+}
+
+void System::ThreadPool::Submit(std::function<void()> task) {
+    if (m_Workers.empty()) {
+        task();
+        return;
+    }
+
+    {
+        std::lock_guard lock(m_Mutex);
+        m_Tasks.push_back(std::move(task));
+    }
+
+    m_Condition.notify_one();
+}
+
+void System::ThreadPool::ParallelFor(std::size_t count, std::size_t grain, const std::function<void(std::size_t, std::size_t)>& body) {
+    grain = std::max<std::size_t>(1u, grain);
+
+    const std::size_t chunks = (count + grain - 1u) / grain;
+
+    if (chunks <= 1u || m_Workers.empty()) {
+        if (count) {
+            body(0u, count);
+        }
+
+        return;
+    }
+
+    struct State {
+        std::atomic<std::size_t> Next{0u};
+        std::atomic<std::size_t> Done{0u};
+
+        std::mutex Mutex;
+        std::condition_variable Finished;
+    };
+
+    // helpers may only get scheduled after everything is done, they must not outlive the state
+    auto state = std::make_shared<State>();
+
+    // chunks are claimed before they run, so `body` is never touched once the caller has returned
+    auto run = [state, &body, count, grain, chunks] {
+        for (std::size_t chunk; (chunk = state->Next.fetch_add(1u)) < chunks;) {
+            body(chunk * grain, std::min(count, (chunk + 1u) * grain));
+
+            if (state->Done.fetch_add(1u) + 1u == chunks) {
+                std::lock_guard lock(state->Mutex);
+                state->Finished.notify_all();
+            }
+        }
+    };
+
+    const std::size_t helpers = std::min(m_Workers.size(), chunks - 1u);
+
+    for (std::size_t i = 0u; i < helpers; ++i) {
+        Submit(run);
+    }
+
+    run();
+
+    std::unique_lock lock(state->Mutex);
+    state->Finished.wait(lock, [&] { return state->Done.load() == chunks; });
+}
@@ -1,13 +1,111 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "App/Batch.hpp"
+
 #include "System/Launcher.hpp"
+#include "System/Profiler.hpp"
+
+#include "Math/Jit.hpp"
+
+int main(int argc, char** argv) {
+    const char* sessionPath = nullptr;
+    std::vector<std::string> dataPaths;
+    const char* streamPath = nullptr;
+    double streamWindow = 10.0;
+    bool streamDrop = false;
+    const char* batchPath = nullptr;
+    std::string outputDirectory = ".";
+    std::string imageSize = "640x360";
+    std::string viewSpec = "-4,4,-2.25,2.25";
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--jit") == 0) {
+            Math::Jit::SetEnabled(true);
+        }
+
+        else if (std::strcmp(argv[i], "--session") == 0 && i + 1 < argc) {
+            sessionPath = argv[++i];
+        }
+
+        else if (std::strcmp(argv[i], "--data") == 0 && i + 1 < argc) {
+            dataPaths.emplace_back(argv[++i]);
+        }
+
+        else if (std::strcmp(argv[i], "--stream") == 0 && i + 1 < argc) {
+            streamPath = argv[++i];
+        }
+
+        else if (std::strcmp(argv[i], "--window") == 0 && i + 1 < argc) {
+            streamWindow = std::strtod(argv[++i], nullptr);
+        }
+
+        else if (std::strcmp(argv[i], "--drop") == 0) {
+            streamDrop = true;
+        }
+
+        else if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batchPath = argv[++i];
+        }
+
+        else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            outputDirectory = argv[++i];
+        }
+
+        else if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            imageSize = argv[++i];
+        }
+
+        else if (std::strcmp(argv[i], "--view") == 0 && i + 1 < argc) {
+            viewSpec = argv[++i];
+        }
+    }
+
+    // renders the equations to images and exits without ever opening a window
+    if (batchPath) {
+        auto size = Batch::ParseSize(imageSize);
+
+        if (!size) {
+            std::cerr << "ERROR: " << size.error() << std::endl;
+            return 1;
+        }
+
+        auto view = Batch::ParseView(viewSpec, size.value());
+
+        if (!view) {
+            std::cerr << "ERROR: " << view.error() << std::endl;
+            return 1;
+        }
+
+        auto summary = Batch::Run(batchPath, outputDirectory, view.value());
+
+        if (!summary) {
+            std::cerr << "ERROR: " << summary.error() << std::endl;
+            return 1;
+        }
+
+        std::cout << summary.value().Rendered << " rendered, " << summary.value().Failed << " failed" << std::endl;
+
+        PROFILE_WRITE("trace.json");
+
+        return summary.value().Failed ? 1 : 0;
+    }
 
-int main(int, char**) {
     Launcher launcher({
         .WindowWidth = 1500u,
         .WindowHeight = 850u,
         .Fps = 60u,
         .WindowTitle = "Graph Visualiser",
         .WindowStyle = sf::Style::Default,
-        .Fullscreen = false
+        .Fullscreen = false,
+        .SessionPath = sessionPath,
+        .DataPaths = std::move(dataPaths),
+        .StreamPath = streamPath,
+        .StreamWindow = streamWindow,
+        .StreamDrop = streamDrop
     });
 
     if (!launcher.LoadResources("Resources/")) [[unlikely]] {
@@ -20,5 +118,7 @@ int main(int, char**) {
         launcher.Render();
     }
 
+    PROFILE_WRITE("trace.json");
+
     return 0;
 }
\ No newline at end of file